@@ -0,0 +1,216 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesettingssnapshot.h"
+
+#include <QRegExp>
+#include <QtTest>
+
+Q_DECLARE_METATYPE( Breeze::ExceptionRuleList )
+
+using namespace Breeze;
+
+//* compares exception resolution with the sequential QRegExp loop it replaces
+class ExceptionResolutionTest: public QObject
+{
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    void firstMatch_data();
+    void firstMatch();
+
+    private:
+
+    //* exception with given pattern and type. Exceptions override opacity, so that each gets its own config
+    static ExceptionRule exception( const QString& pattern, int type, bool isDialog = false, bool enabled = true );
+
+    //* index of first matching exception, -1 if none, the way exceptions were matched with QRegExp
+    static int referenceMatch( const ExceptionRuleList&, const ResolutionKey& );
+
+    //* config expected for given exception index
+    static DecorationConfigPtr expectedConfig( const SettingsSnapshot&, const ExceptionRuleList&, int );
+
+};
+
+//__________________________________________________________________
+ExceptionRule ExceptionResolutionTest::exception( const QString& pattern, int type, bool isDialog, bool enabled )
+{
+    static int opacity = 0;
+
+    ExceptionRule exception;
+    exception.pattern = pattern;
+    exception.type = type;
+    exception.isDialog = isDialog;
+    exception.enabled = enabled;
+    exception.opacityOverride = opacity;
+    opacity = ( opacity + 1 )%100;
+    return exception;
+}
+
+//__________________________________________________________________
+int ExceptionResolutionTest::referenceMatch( const ExceptionRuleList& exceptions, const ResolutionKey& key )
+{
+    for( int i = 0; i < exceptions.size(); ++i )
+    {
+        const ExceptionRule& exception( exceptions[i] );
+        if( !exception.enabled ) continue;
+        if( exception.pattern.isEmpty() ) continue;
+        if( exception.isDialog && !key.isDialog ) continue;
+
+        const QString& value( exception.type == InternalSettings::ExceptionWindowTitle ? key.title : key.className );
+        if( QRegExp( exception.pattern ).indexIn( value ) >= 0 ) return i;
+    }
+
+    return -1;
+}
+
+//__________________________________________________________________
+DecorationConfigPtr ExceptionResolutionTest::expectedConfig( const SettingsSnapshot& snapshot, const ExceptionRuleList& exceptions, int index )
+{
+    if( index < 0 ) return snapshot.defaultConfig;
+
+    // rules keep exception order, skipping those that can never match
+    int rule = 0;
+    for( int i = 0; i < index; ++i )
+    {
+        if( exceptions[i].enabled && !exceptions[i].pattern.isEmpty() )
+        { ++rule; }
+    }
+
+    return snapshot.rules[rule].config;
+}
+
+//__________________________________________________________________
+void ExceptionResolutionTest::firstMatch_data()
+{
+    QTest::addColumn<ExceptionRuleList>( "exceptions" );
+
+    const int className = InternalSettings::ExceptionWindowClassName;
+    const int title = InternalSettings::ExceptionWindowTitle;
+
+    {
+        // literal and regular expression rules interleaved, with shadowed and dialog only rules
+        ExceptionRuleList exceptions;
+        exceptions
+            << exception( QStringLiteral( "konsole" ), className )
+            << exception( QStringLiteral( "^firefox" ), className )
+            << exception( QStringLiteral( "Firefox" ), title )
+            << exception( QStringLiteral( "dolphin" ), className, true )
+            << exception( QStringLiteral( "kate" ), className, false, false )
+            << exception( QStringLiteral( "org\\.kde" ), className )
+            << exception( QStringLiteral( "xterm" ), className )
+            << exception( QStringLiteral( "Save" ), title, true )
+            << exception( QString(), className )
+            << exception( QStringLiteral( "term" ), className )
+            << exception( QStringLiteral( "dolphin" ), className )
+            << exception( QStringLiteral( "kate" ), className )
+            << exception( QStringLiteral( ".*" ), title );
+        QTest::newRow( "mixed" ) << exceptions;
+    }
+
+    {
+        // mostly literal rules, including literals contained in one another
+        ExceptionRuleList exceptions;
+        exceptions
+            << exception( QStringLiteral( "XTerm" ), className )
+            << exception( QStringLiteral( "org.kde.dolphin" ), className, true )
+            << exception( QStringLiteral( "kde" ), className )
+            << exception( QStringLiteral( "Term" ), className )
+            << exception( QStringLiteral( "org" ), className )
+            << exception( QStringLiteral( "fox" ), className );
+        QTest::newRow( "literals" ) << exceptions;
+    }
+
+    {
+        // generated, literal and regular expression rules alternating in exception order
+        const QStringList words( {
+            QStringLiteral( "konsole" ), QStringLiteral( "firefox" ), QStringLiteral( "dolphin" ),
+            QStringLiteral( "kate" ), QStringLiteral( "term" ), QStringLiteral( "kde" ),
+            QStringLiteral( "Save" ), QStringLiteral( "Open" ) } );
+
+        ExceptionRuleList exceptions;
+        for( int i = 0; i < 200; ++i )
+        {
+            const QString& word( words[( i*7 )%words.size()] );
+            const int type = i%5 == 0 ? title : className;
+            const bool isDialog = i%3 == 0;
+            switch( i%4 )
+            {
+                case 0: exceptions << exception( word, type, isDialog ); break;
+                case 1: exceptions << exception( QStringLiteral( "^" ) + word, type, isDialog ); break;
+                case 2: exceptions << exception( word + QStringLiteral( "\\b" ), type, isDialog ); break;
+                default: exceptions << exception( word.left( 3 ) + QStringLiteral( ".*" ), type, isDialog, i%7 != 0 ); break;
+            }
+        }
+
+        QTest::newRow( "generated" ) << exceptions;
+    }
+}
+
+//__________________________________________________________________
+void ExceptionResolutionTest::firstMatch()
+{
+    QFETCH( ExceptionRuleList, exceptions );
+
+    const SettingsSnapshot snapshot( DecorationConfigPtr( new DecorationConfig() ), exceptions );
+
+    const QStringList classNames( {
+        QStringLiteral( "konsole org.kde.konsole" ),
+        QStringLiteral( "firefox Firefox" ),
+        QStringLiteral( "Navigator firefox" ),
+        QStringLiteral( "dolphin org.kde.dolphin" ),
+        QStringLiteral( "kate org.kde.kate" ),
+        QStringLiteral( "xterm XTerm" ),
+        QStringLiteral( "gimp Gimp" ),
+        QStringLiteral( " " ) } );
+
+    const QStringList titles( {
+        QStringLiteral( "Mozilla Firefox" ),
+        QStringLiteral( "Terminal - Konsole" ),
+        QStringLiteral( "Save As" ),
+        QStringLiteral( "Open File" ),
+        QString() } );
+
+    for( const QString& className : classNames )
+    {
+        for( const QString& title : titles )
+        {
+            for( bool isDialog : { false, true } )
+            {
+                ResolutionKey key;
+                key.className = className;
+                key.title = title;
+                key.isDialog = isDialog;
+
+                const int index = referenceMatch( exceptions, key );
+                const DecorationConfigPtr expected( expectedConfig( snapshot, exceptions, index ) );
+                const DecorationConfigPtr resolved( snapshot.resolve( key ) );
+                if( resolved != expected )
+                {
+                    QFAIL( qPrintable( QStringLiteral( "class \"%1\", title \"%2\", dialog %3: expected exception %4" )
+                        .arg( className ).arg( title ).arg( isDialog ).arg( index ) ) );
+                }
+            }
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN( ExceptionResolutionTest )
+
+#include "breezeexceptionresolutiontest.moc"
@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeopaque.h"
+
+#include <QtTest>
+
+using namespace Breeze;
+
+class OpaqueTest: public QObject
+{
+    Q_OBJECT
+
+    public:
+
+    //* border size setting
+    enum Border
+    {
+        BorderNone,
+        BorderNoSides,
+        BorderNormal
+    };
+
+    Q_ENUM( Border )
+
+    private Q_SLOTS:
+
+    void titleBarAlpha_data();
+    void titleBarAlpha();
+
+    void isOpaque_data();
+    void isOpaque();
+
+    private:
+
+    //* geometry, computed the way Decoration::borderSize() and Decoration::recalculateBorders() do
+    static OpaqueGeometry geometry( Border, bool maximized, int fontHeight, bool hideTitleBar );
+
+};
+
+namespace
+{
+    //* small spacing
+    const int smallSpacing = 4;
+
+    //* button height
+    const int buttonHeight = 20;
+}
+
+//__________________________________________________________________
+OpaqueGeometry OpaqueTest::geometry( Border border, bool maximized, int fontHeight, bool hideTitleBar )
+{
+    const int side = border == BorderNormal ? smallSpacing : 0;
+    const int bottom = border == BorderNone ? 0 : qMax( 4, smallSpacing );
+
+    OpaqueGeometry geometry;
+    geometry.borderSize = side;
+    geometry.buttonHeight = buttonHeight;
+    geometry.hideTitleBar = hideTitleBar;
+
+    // maximized windows sit on the bottom screen edge
+    geometry.borderBottom = maximized ? 0 : bottom;
+    if( hideTitleBar ) geometry.borderTop = geometry.borderBottom;
+    else geometry.borderTop = ( maximized ? 0 : side ) + qMax( fontHeight, buttonHeight );
+
+    return geometry;
+}
+
+//__________________________________________________________________
+void OpaqueTest::titleBarAlpha_data()
+{
+    QTest::addColumn<bool>( "opaqueTitleBar" );
+    QTest::addColumn<int>( "backgroundOpacity" );
+    QTest::addColumn<int>( "opacityOverride" );
+    QTest::addColumn<int>( "alpha" );
+
+    QTest::newRow( "opaque title bar" ) << true << 50 << 20 << 255;
+    QTest::newRow( "full opacity" ) << false << 100 << -1 << 255;
+    QTest::newRow( "half opacity" ) << false << 50 << -1 << 128;
+    QTest::newRow( "transparent" ) << false << 0 << -1 << 0;
+    QTest::newRow( "override to full" ) << false << 50 << 100 << 255;
+    QTest::newRow( "override to half" ) << false << 100 << 50 << 128;
+    QTest::newRow( "out of range" ) << false << 150 << -1 << 255;
+}
+
+//__________________________________________________________________
+void OpaqueTest::titleBarAlpha()
+{
+    QFETCH( bool, opaqueTitleBar );
+    QFETCH( int, backgroundOpacity );
+    QFETCH( int, opacityOverride );
+    QFETCH( int, alpha );
+
+    QCOMPARE( Breeze::titleBarAlpha( opaqueTitleBar, backgroundOpacity, opacityOverride ), alpha );
+}
+
+//__________________________________________________________________
+void OpaqueTest::isOpaque_data()
+{
+    QTest::addColumn<Border>( "border" );
+    QTest::addColumn<bool>( "maximized" );
+    QTest::addColumn<int>( "fontHeight" );
+    QTest::addColumn<bool>( "hideTitleBar" );
+    QTest::addColumn<int>( "alpha" );
+    QTest::addColumn<bool>( "opaque" );
+
+    const int smallFont = buttonHeight - 4;
+    const int largeFont = buttonHeight + 4;
+
+    // painted frame covers everything but the title bar
+    QTest::newRow( "normal" ) << BorderNormal << false << smallFont << false << 255 << true;
+    QTest::newRow( "normal, maximized" ) << BorderNormal << true << smallFont << false << 255 << true;
+    QTest::newRow( "normal, large font" ) << BorderNormal << false << largeFont << false << 255 << true;
+    QTest::newRow( "normal, hidden title bar" ) << BorderNormal << false << smallFont << true << 255 << true;
+    QTest::newRow( "normal, translucent" ) << BorderNormal << false << smallFont << false << 254 << false;
+    QTest::newRow( "normal, maximized, translucent" ) << BorderNormal << true << smallFont << false << 128 << false;
+
+    // borderSize() == 0, title bar only
+    QTest::newRow( "none" ) << BorderNone << false << smallFont << false << 255 << true;
+    QTest::newRow( "none, maximized" ) << BorderNone << true << smallFont << false << 255 << true;
+    QTest::newRow( "none, translucent" ) << BorderNone << false << smallFont << false << 128 << false;
+    QTest::newRow( "none, hidden title bar" ) << BorderNone << false << smallFont << true << 255 << true;
+
+    // font taller than buttons leaves a strip below the title bar unpainted
+    QTest::newRow( "none, large font" ) << BorderNone << false << largeFont << false << 255 << false;
+    QTest::newRow( "none, maximized, large font" ) << BorderNone << true << largeFont << false << 255 << false;
+
+    // NoSides keeps an unpainted bottom strip, unless maximized
+    QTest::newRow( "no sides" ) << BorderNoSides << false << smallFont << false << 255 << false;
+    QTest::newRow( "no sides, maximized" ) << BorderNoSides << true << smallFont << false << 255 << true;
+    QTest::newRow( "no sides, maximized, translucent" ) << BorderNoSides << true << smallFont << false << 128 << false;
+    QTest::newRow( "no sides, maximized, large font" ) << BorderNoSides << true << largeFont << false << 255 << false;
+    QTest::newRow( "no sides, hidden title bar" ) << BorderNoSides << false << smallFont << true << 255 << false;
+    QTest::newRow( "no sides, maximized, hidden title bar" ) << BorderNoSides << true << smallFont << true << 255 << true;
+}
+
+//__________________________________________________________________
+void OpaqueTest::isOpaque()
+{
+    QFETCH( Border, border );
+    QFETCH( bool, maximized );
+    QFETCH( int, fontHeight );
+    QFETCH( bool, hideTitleBar );
+    QFETCH( int, alpha );
+    QFETCH( bool, opaque );
+
+    QCOMPARE( Breeze::isOpaque( geometry( border, maximized, fontHeight, hideTitleBar ), alpha ), opaque );
+}
+
+QTEST_GUILESS_MAIN( OpaqueTest )
+
+#include "breezeopaquetest.moc"
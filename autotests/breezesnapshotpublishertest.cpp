@@ -0,0 +1,170 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//* snapshot publishing, with readers running concurrently to the writer
+/*!
+    the stress test is meant to run under ThreadSanitizer or AddressSanitizer,
+    configured with -DECM_ENABLE_SANITIZERS=thread or address, which report any
+    data race or snapshot deleted while still read
+*/
+
+#include "breezesnapshotpublisher.h"
+
+#include <QtTest>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace Breeze;
+
+class SnapshotPublisherTest: public QObject
+{
+    Q_OBJECT
+
+    private Q_SLOTS:
+
+    void reclaim();
+    void concurrentReaders();
+
+    private:
+
+    //* snapshot whose settings all carry given generation as background opacity
+    static const SettingsSnapshot* snapshot( int generation );
+
+};
+
+//__________________________________________________________________
+const SettingsSnapshot* SnapshotPublisherTest::snapshot( int generation )
+{
+    DecorationConfig* defaultConfig( new DecorationConfig() );
+    defaultConfig->backgroundOpacity = generation%100;
+
+    ExceptionRuleList exceptions;
+
+    ExceptionRule literal;
+    literal.pattern = QStringLiteral( "konsole" );
+    literal.hideTitleBar = true;
+    exceptions.append( literal );
+
+    ExceptionRule expression;
+    expression.pattern = QStringLiteral( "^fire" );
+    expression.opacityOverride = 50;
+    exceptions.append( expression );
+
+    ExceptionRule title;
+    title.pattern = QStringLiteral( "Document \\d+" );
+    title.type = InternalSettings::ExceptionWindowTitle;
+    title.opaqueTitleBar = true;
+    exceptions.append( title );
+
+    return new SettingsSnapshot( DecorationConfigPtr( defaultConfig ), exceptions, true, generation );
+}
+
+//__________________________________________________________________
+void SnapshotPublisherTest::reclaim()
+{
+    SnapshotPublisher publisher( snapshot( 0 ) );
+
+    {
+        // a reader keeps its snapshot alive across publishing
+        const SnapshotPublisher::Reader reader( publisher );
+        QCOMPARE( reader->dynamicTitleExceptionsDelay, 0 );
+
+        publisher.publish( snapshot( 1 ) );
+        QCOMPARE( publisher.reclaim(), 1 );
+        QCOMPARE( reader->dynamicTitleExceptionsDelay, 0 );
+        QCOMPARE( reader->defaultConfig->backgroundOpacity, 0 );
+
+        // new readers get the new snapshot
+        QCOMPARE( SnapshotPublisher::Reader( publisher )->dynamicTitleExceptionsDelay, 1 );
+        QCOMPARE( publisher.reclaim(), 1 );
+    }
+
+    // once the reader is gone
+    QCOMPARE( publisher.reclaim(), 0 );
+
+    // without readers, retired snapshots are deleted right away
+    publisher.publish( snapshot( 2 ) );
+    publisher.publish( snapshot( 3 ) );
+    QCOMPARE( publisher.reclaim(), 0 );
+    QCOMPARE( SnapshotPublisher::Reader( publisher )->dynamicTitleExceptionsDelay, 3 );
+}
+
+//__________________________________________________________________
+void SnapshotPublisherTest::concurrentReaders()
+{
+    const int readerCount = qMax( 2, QThread::idealThreadCount() );
+    const int generations = 2000;
+
+    SnapshotPublisher publisher( snapshot( 0 ) );
+    std::atomic<bool> done( false );
+    std::atomic<int> reads( 0 );
+    std::atomic<int> failures( 0 );
+
+    const QVector<ResolutionKey> keys( [] {
+        QVector<ResolutionKey> keys;
+        for( const QString& className : { QStringLiteral( "konsole org.kde.konsole" ), QStringLiteral( "firefox Firefox" ), QStringLiteral( "xterm XTerm" ) } )
+        {
+            ResolutionKey key;
+            key.className = className;
+            key.title = QStringLiteral( "Document 1" );
+            keys.append( key );
+        }
+        return keys;
+    }() );
+
+    std::vector<std::thread> readers;
+    for( int i = 0; i < readerCount; ++i )
+    {
+        readers.emplace_back( [&publisher, &done, &reads, &failures, &keys, i]()
+        {
+            for( int n = i; !done.load(); ++n )
+            {
+                // all settings of a snapshot come from the same generation
+                const SnapshotPublisher::Reader reader( publisher );
+                const DecorationConfigPtr config( reader->resolve( keys[n%keys.size()] ) );
+                const int generation( reader->dynamicTitleExceptionsDelay );
+                if( config->backgroundOpacity != generation%100 || reader->defaultConfig->backgroundOpacity != generation%100 )
+                { ++failures; }
+
+                ++reads;
+            }
+        } );
+    }
+
+    for( int generation = 1; generation <= generations; ++generation )
+    {
+        publisher.publish( snapshot( generation ) );
+        publisher.reclaim();
+        if( generation%16 == 0 ) std::this_thread::yield();
+    }
+
+    done = true;
+    for( std::thread& reader : readers )
+    { reader.join(); }
+
+    QCOMPARE( failures.load(), 0 );
+    QVERIFY( reads.load() > 0 );
+    QCOMPARE( publisher.reclaim(), 0 );
+    QCOMPARE( SnapshotPublisher::Reader( publisher )->dynamicTitleExceptionsDelay, generations );
+}
+
+QTEST_GUILESS_MAIN( SnapshotPublisherTest )
+
+#include "breezesnapshotpublishertest.moc"
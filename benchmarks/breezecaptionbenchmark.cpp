@@ -0,0 +1,144 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//* caption sanitizing and elision time for adversarial titles
+/*!
+    each title is elided for a sequence of title bar widths, as during an interactive resize.
+    The baseline elides the raw caption on every paint, the way captions were painted before
+    sanitizing. The sanitized path bounds and filters the caption once, then elides it through
+    the cached layout used by Decoration::elidedCaption.
+
+    needs a platform plugin for font metrics, run with -platform offscreen if no display is available
+*/
+
+#include "breezecaption.h"
+
+#include <QElapsedTimer>
+#include <QFont>
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QTextStream>
+#include <QVector>
+
+#include <initializer_list>
+
+namespace
+{
+
+    //* minimum number of caption characters kept, as in Decoration
+    const int minCaptionLength = 512;
+
+    //* client width, the title bar being somewhat narrower
+    const int clientWidth = 800;
+
+    //* number of widths each title is elided to
+    const int resizeSteps = 20;
+
+    //* title bar width for given resize step
+    int titleWidth( int step )
+    { return clientWidth - 100 - 10*step; }
+
+    //* title of about given length, repeating given pattern
+    QString repeated( const QString& pattern, int length )
+    {
+        QString title;
+        title.reserve( length + pattern.size() );
+        while( title.size() < length ) title.append( pattern );
+        return title;
+    }
+
+    //* adversarial title
+    struct Title
+    {
+        QString name;
+        QString caption;
+    };
+
+    //* string from given code points
+    QString fromUnicode( std::initializer_list<ushort> codes )
+    {
+        QString out;
+        for( ushort code : codes ) out.append( QChar( code ) );
+        return out;
+    }
+
+    //* adversarial titles, each a few tens of thousands of characters or more
+    QVector<Title> titles()
+    {
+        QVector<Title> titles;
+
+        // megabyte long plain title
+        titles.append( { QStringLiteral( "megabyte" ), repeated( QStringLiteral( "Document - Editor " ), 1<<20 ) } );
+
+        // every letter carrying a stack of combining marks
+        titles.append( { QStringLiteral( "combining marks" ), repeated(
+            fromUnicode( { 'a', 0x0301, 0x0302, 0x0303, 0x0304, 0x0306, 0x0307, 0x0308, 0x030a } ), 1<<16 ) } );
+
+        // letters interleaved with control characters
+        titles.append( { QStringLiteral( "control characters" ), repeated(
+            fromUnicode( { 'a', 0x01, 0x02, '\t', 'b', 0x1b, 0x7f, '\r', '\n', 0x85 } ), 1<<16 ) } );
+
+        // nested, unterminated embeddings, overrides and isolates
+        titles.append( { QStringLiteral( "bidi controls" ), repeated(
+            fromUnicode( { 0x202e, 'a', 'b', 0x202a, 0x2067, 'c', 'd', 0x202b, 0x2066, 'e', 'f', 0x202d, 0x2068, 0x202c, 0x2069 } ), 1<<16 ) } );
+
+        return titles;
+    }
+
+}
+
+//__________________________________________________________________
+int main( int argc, char** argv )
+{
+
+    QGuiApplication application( argc, argv );
+    QTextStream out( stdout );
+
+    const QFontMetrics metrics( QGuiApplication::font() );
+    out << resizeSteps << " title bar widths from " << titleWidth( 0 ) << " to " << titleWidth( resizeSteps - 1 ) << " pixels" << Qt::endl;
+
+    QElapsedTimer timer;
+    for( const Title& title : titles() )
+    {
+
+        out << title.name << ", " << title.caption.size() << " characters" << Qt::endl;
+
+        // baseline, eliding the raw caption on every paint
+        timer.start();
+        int length = 0;
+        for( int step = 0; step < resizeSteps; ++step )
+        { length += metrics.elidedText( title.caption, Qt::ElideMiddle, titleWidth( step ) ).size(); }
+        out << "  unsanitized:      " << timer.nsecsElapsed()/1000000.0 << " ms, " << length << " characters painted" << Qt::endl;
+
+        // sanitized once per caption change, then elided through the layout cache
+        timer.start();
+        Breeze::CaptionLayout layout;
+        layout.caption = Breeze::sanitizeCaption( title.caption, qMax( minCaptionLength, 2*clientWidth ) );
+        layout.width = clientWidth;
+        const qreal sanitize( timer.nsecsElapsed()/1000000.0 );
+
+        length = 0;
+        for( int step = 0; step < resizeSteps; ++step )
+        { length += layout.elidedCaption( metrics, titleWidth( step ) ).size(); }
+        out << "  sanitized:        " << timer.nsecsElapsed()/1000000.0 << " ms, " << length << " characters painted, " << sanitize << " ms sanitizing" << Qt::endl;
+
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,210 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//* exception loading and resolution time for many windows against many rules
+/*!
+    compares the compiled snapshot, with its literal index and precompiled expressions,
+    to the sequential loop that built a QRegExp per exception and per window.
+
+    loading is measured from a configuration file holding many exception groups, comparing
+    ExceptionList::readRules followed by snapshot construction to ExceptionList::readConfig,
+    which builds and loads a complete InternalSettings per exception. The configuration file
+    is written to a temporary XDG_CONFIG_HOME, so that user settings are left untouched
+*/
+
+#include "breezeexceptionlist.h"
+#include "breezesettingssnapshot.h"
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegExp>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <malloc.h>
+
+namespace
+{
+
+    //* number of windows
+    const int windowCount = 10000;
+
+    //* number of exceptions
+    const int ruleCount = 500;
+
+    //* number of exception groups in the configuration file
+    const int groupCount = 1000;
+
+    //* fraction of exceptions that are plain class names, in percent
+    const int literalPercent = 80;
+
+    //* exceptions. Most are plain class names, the others are regular expressions on class name or title
+    Breeze::ExceptionRuleList exceptions( int count )
+    {
+        Breeze::ExceptionRuleList exceptions;
+        for( int i = 0; i < count; ++i )
+        {
+            Breeze::ExceptionRule exception;
+            exception.opacityOverride = i%100;
+            if( i%100 < literalPercent )
+            {
+                exception.pattern = QStringLiteral( "application%1" ).arg( i );
+            } else if( i%2 ) {
+                exception.pattern = QStringLiteral( "^tool%1\\b" ).arg( i );
+            } else {
+                exception.type = Breeze::InternalSettings::ExceptionWindowTitle;
+                exception.pattern = QStringLiteral( "Document %1 .*" ).arg( i );
+            }
+
+            exceptions.append( exception );
+        }
+
+        return exceptions;
+    }
+
+    //* window properties. A third of the windows match no exception
+    QVector<Breeze::ResolutionKey> windows()
+    {
+        QVector<Breeze::ResolutionKey> windows;
+        windows.reserve( windowCount );
+        for( int i = 0; i < windowCount; ++i )
+        {
+            Breeze::ResolutionKey key;
+            const int rule = ( i*7919 )%( 3*ruleCount/2 );
+            key.className = QStringLiteral( "application%1 Application%1" ).arg( rule );
+            key.title = QStringLiteral( "Document %1 - Editor" ).arg( rule );
+            windows.append( key );
+        }
+
+        return windows;
+    }
+
+    //* first matching exception, the way exceptions were matched with QRegExp
+    int sequentialMatch( const Breeze::ExceptionRuleList& exceptions, const Breeze::ResolutionKey& key )
+    {
+        for( int i = 0; i < exceptions.size(); ++i )
+        {
+            const Breeze::ExceptionRule& exception( exceptions[i] );
+            const QString& value( exception.type == Breeze::InternalSettings::ExceptionWindowTitle ? key.title : key.className );
+            if( QRegExp( exception.pattern ).indexIn( value ) >= 0 ) return i;
+        }
+
+        return -1;
+    }
+
+    //* write exceptions to given configuration, the way the configuration module does
+    void writeExceptions( KSharedConfig::Ptr config, const Breeze::ExceptionRuleList& rules )
+    {
+        Breeze::InternalSettingsList exceptions;
+        for( const Breeze::ExceptionRule& rule : rules )
+        {
+            Breeze::InternalSettingsPtr exception( new Breeze::InternalSettings() );
+            exception->setEnabled( rule.enabled );
+            exception->setExceptionType( rule.type );
+            exception->setExceptionPattern( rule.pattern );
+            exception->setMask( rule.mask );
+            exception->setOpacityOverride( rule.opacityOverride );
+            exceptions.append( exception );
+        }
+
+        Breeze::ExceptionList( exceptions ).writeConfig( config );
+        config->sync();
+    }
+
+    //* bytes currently allocated on the heap
+    size_t allocatedBytes()
+    {
+        #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+        #else
+        return mallinfo().uordblks;
+        #endif
+    }
+
+}
+
+//__________________________________________________________________
+int main( int argc, char** argv )
+{
+
+    // settings are read from and written to a temporary location
+    QTemporaryDir configHome;
+    qputenv( "XDG_CONFIG_HOME", QFile::encodeName( configHome.path() ) );
+
+    QCoreApplication application( argc, argv );
+    QTextStream out( stdout );
+
+    QElapsedTimer timer;
+
+    {
+        // loading
+        KSharedConfig::Ptr config( KSharedConfig::openConfig( QStringLiteral( "breezerc" ) ) );
+        writeExceptions( config, exceptions( groupCount ) );
+        out << groupCount << " exception groups" << Qt::endl;
+
+        // one InternalSettings per exception, each loading the whole configuration
+        size_t before = allocatedBytes();
+        timer.start();
+        QScopedPointer<Breeze::ExceptionList> exceptionList( new Breeze::ExceptionList() );
+        exceptionList->readConfig( config );
+        out << "InternalSettings: " << timer.elapsed() << " ms, " << ( allocatedBytes() - before )/1024 << " kB, " << exceptionList->get().size() << " exceptions" << Qt::endl;
+        exceptionList.reset();
+
+        // compact rules, compiled into a snapshot
+        before = allocatedBytes();
+        timer.start();
+        Breeze::InternalSettings defaultSettings;
+        defaultSettings.setCurrentGroup( QStringLiteral( "Windeco" ) );
+        defaultSettings.load();
+        QScopedPointer<const Breeze::SettingsSnapshot> snapshot( new Breeze::SettingsSnapshot(
+            Breeze::DecorationConfigPtr( new Breeze::DecorationConfig( defaultSettings ) ),
+            Breeze::ExceptionList::readRules( config ) ) );
+        out << "snapshot:         " << timer.elapsed() << " ms, " << ( allocatedBytes() - before )/1024 << " kB, " << snapshot->rules.size() << " exceptions" << Qt::endl;
+    }
+
+    // resolution
+    const Breeze::ExceptionRuleList rules( exceptions( ruleCount ) );
+    const QVector<Breeze::ResolutionKey> keys( windows() );
+    out << windowCount << " windows, " << ruleCount << " exceptions, " << literalPercent << "% plain class names" << Qt::endl;
+
+    int matched = 0;
+
+    // sequential QRegExp loop
+    timer.start();
+    for( const Breeze::ResolutionKey& key : keys )
+    { if( sequentialMatch( rules, key ) >= 0 ) ++matched; }
+    out << "QRegExp loop:     " << timer.elapsed() << " ms, " << matched << " windows matched" << Qt::endl;
+
+    // snapshot, including the time needed to compile rules
+    timer.start();
+    const Breeze::SettingsSnapshot snapshot( Breeze::DecorationConfigPtr( new Breeze::DecorationConfig() ), rules );
+    const qint64 compile = timer.elapsed();
+
+    matched = 0;
+    for( const Breeze::ResolutionKey& key : keys )
+    { if( snapshot.resolve( key ) != snapshot.defaultConfig ) ++matched; }
+    out << "snapshot:         " << timer.elapsed() << " ms, " << matched << " windows matched, " << compile << " ms compiling rules" << Qt::endl;
+
+    return 0;
+
+}
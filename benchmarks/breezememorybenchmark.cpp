@@ -0,0 +1,260 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//* heap footprint of per-button animation state, for the eager baseline and lazy allocation
+/*!
+    a decoration is modelled by its full set of buttons, each being a QObject connected to stand-ins
+    for the client, settings and decoration. Baseline buttons allocate a QPropertyAnimation on the
+    opacity property at construction and connect to the settings and client signals, the way buttons
+    did before allocation became lazy. Lazy buttons follow Button::updateAnimationState: only the menu
+    button connects to the client, and the animation is allocated on first hover.
+*/
+
+#include "breezeanimation.h"
+
+#include <QCoreApplication>
+#include <QEasingCurve>
+#include <QObject>
+#include <QPropertyAnimation>
+#include <QScopedPointer>
+#include <QTextStream>
+
+#include <malloc.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+    //* number of decorations
+    const int decorationCount = 1000;
+
+    //* buttons per decoration: menu, application menu, on all desktops, minimize, maximize,
+    //* close, context help, shade, keep below and keep above
+    const int buttonCount = 10;
+
+    //* animation duration, as in the default settings
+    const int animationsDuration = 150;
+
+    //* stand-in for the client and settings signals buttons connect to
+    class Source: public QObject
+    {
+        Q_OBJECT
+
+        Q_SIGNALS:
+
+        void reconfigured();
+        void iconChanged();
+
+    };
+
+    //* stand-in for the decoration, whose cached title bars depend on button state
+    class Decoration: public QObject
+    {
+        Q_OBJECT
+
+        public Q_SLOTS:
+
+        void updateButtonState()
+        {}
+
+    };
+
+    //* stand-in for a decoration button, with the state signals of KDecoration2::DecorationButton
+    class Button: public QObject
+    {
+        Q_OBJECT
+
+        Q_PROPERTY( qreal opacity READ opacity WRITE setOpacity )
+
+        public:
+
+        qreal opacity() const
+        { return m_opacity; }
+
+        void setOpacity( qreal value )
+        { m_opacity = value; }
+
+        //* hover
+        void hover()
+        { emit hoveredChanged( true ); }
+
+        Q_SIGNALS:
+
+        void hoveredChanged( bool );
+        void pressedChanged( bool );
+        void checkedChanged( bool );
+        void visibilityChanged( bool );
+
+        public Q_SLOTS:
+
+        void update()
+        {}
+
+        private:
+
+        qreal m_opacity = 0;
+
+    };
+
+    //* button as it was before lazy allocation
+    class EagerButton: public Button
+    {
+        public:
+
+        //* constructor
+        EagerButton( Source* settings, Source* client, bool isMenu ):
+            m_animation( new QPropertyAnimation( this ) )
+        {
+            // setup animation
+            m_animation->setStartValue( 0 );
+            m_animation->setEndValue( 1.0 );
+            m_animation->setTargetObject( this );
+            m_animation->setPropertyName( "opacity" );
+            m_animation->setEasingCurve( QEasingCurve::InOutQuad );
+
+            // connections
+            connect( client, SIGNAL(iconChanged()), this, SLOT(update()) );
+            connect( settings, &Source::reconfigured, this, [this]() { m_animation->setDuration( animationsDuration ); } );
+            connect( this, &Button::hoveredChanged, this, [this]( bool hovered )
+            {
+                m_animation->setDirection( hovered ? QAbstractAnimation::Forward : QAbstractAnimation::Backward );
+                if( m_animation->state() != QAbstractAnimation::Running ) m_animation->start();
+            } );
+
+            if( isMenu )
+            { connect( client, &Source::iconChanged, this, [this]() { update(); } ); }
+
+            m_animation->setDuration( animationsDuration );
+        }
+
+        private:
+
+        QPropertyAnimation* m_animation;
+
+    };
+
+    //* button with its animation allocated on first hover
+    class LazyButton: public Button
+    {
+        public:
+
+        //* constructor
+        LazyButton( Decoration* decoration, Source* client, bool isMenu )
+        {
+            if( isMenu )
+            { connect( client, &Source::iconChanged, this, &Button::update ); }
+
+            connect( this, &Button::hoveredChanged, this, [this]( bool hovered ) { updateAnimationState( hovered ); } );
+
+            // buttons are part of the cached title bars
+            connect( this, &Button::hoveredChanged, decoration, &Decoration::updateButtonState );
+            connect( this, &Button::pressedChanged, decoration, &Decoration::updateButtonState );
+            connect( this, &Button::checkedChanged, decoration, &Decoration::updateButtonState );
+            connect( this, &Button::visibilityChanged, decoration, &Decoration::updateButtonState );
+        }
+
+        private:
+
+        //* as Button::updateAnimationState
+        void updateAnimationState( bool hovered )
+        {
+            if( !m_animation )
+            {
+                if( !hovered ) return;
+                m_animation.reset( new Breeze::Animation( [this]( qreal value ) { setOpacity( value ); } ) );
+            }
+
+            m_animation->setDuration( animationsDuration );
+
+            const Breeze::Animation::Direction dir = hovered ? Breeze::Animation::Forward : Breeze::Animation::Backward;
+            if( m_animation->isRunning() && m_animation->direction() != dir )
+                m_animation->stop();
+            m_animation->setDirection( dir );
+            if( !m_animation->isRunning() ) m_animation->start();
+        }
+
+        QScopedPointer<Breeze::Animation> m_animation;
+
+    };
+
+    //* bytes currently allocated on the heap
+    size_t allocatedBytes()
+    {
+        #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+        #else
+        return mallinfo().uordblks;
+        #endif
+    }
+
+    //* bytes per decoration for all buttons, with given number of hovered buttons per decoration
+    qreal measure( bool lazy, int hovered )
+    {
+
+        Source settings;
+        std::vector<std::unique_ptr<Source>> clients;
+        std::vector<std::unique_ptr<Decoration>> decorations;
+        clients.reserve( decorationCount );
+        decorations.reserve( decorationCount );
+        for( int i = 0; i < decorationCount; ++i )
+        {
+            clients.emplace_back( new Source );
+            decorations.emplace_back( new Decoration );
+        }
+
+        std::vector<std::unique_ptr<Button>> buttons;
+        buttons.reserve( decorationCount*buttonCount );
+
+        const size_t before = allocatedBytes();
+        for( int i = 0; i < decorationCount; ++i )
+        {
+            for( int j = 0; j < buttonCount; ++j )
+            {
+                if( lazy ) buttons.emplace_back( new LazyButton( decorations[i].get(), clients[i].get(), j == 0 ) );
+                else buttons.emplace_back( new EagerButton( &settings, clients[i].get(), j == 0 ) );
+                if( j < hovered ) buttons.back()->hover();
+            }
+        }
+
+        const size_t after = allocatedBytes();
+        return qreal( after - before )/decorationCount;
+
+    }
+
+}
+
+//__________________________________________________________________
+int main( int argc, char** argv )
+{
+
+    QCoreApplication application( argc, argv );
+    QTextStream out( stdout );
+
+    out << decorationCount << " decorations, " << buttonCount << " buttons each" << Qt::endl;
+    out << "baseline, never hovered:   " << measure( false, 0 ) << " bytes per decoration" << Qt::endl;
+    out << "baseline, all hovered:     " << measure( false, buttonCount ) << " bytes per decoration" << Qt::endl;
+    out << "lazy, never hovered:       " << measure( true, 0 ) << " bytes per decoration" << Qt::endl;
+    out << "lazy, one hovered:         " << measure( true, 1 ) << " bytes per decoration" << Qt::endl;
+    out << "lazy, all hovered:         " << measure( true, buttonCount ) << " bytes per decoration" << Qt::endl;
+
+    return 0;
+
+}
+
+#include "breezememorybenchmark.moc"
@@ -0,0 +1,280 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//* reconfiguration time for many decorations, once a default setting changed
+/*!
+    decorations share a limited number of resolution keys, as windows of the same application do.
+    The sweep follows SettingsProvider::reconfigure: settings and rules are read once into a snapshot,
+    each decoration's key is resolved through the memoised resolutions, and only the parts that changed
+    are applied. The previous path read every exception into its own InternalSettings, then matched
+    each decoration against them with QRegExp, applying all parts.
+
+    window class names are given, so the KWindowInfo requests the previous path made for each
+    decoration are not included in its time. The configuration file is written to a temporary
+    XDG_CONFIG_HOME, so that user settings are left untouched
+*/
+
+#include "breezeexceptionlist.h"
+#include "breezesettingssnapshot.h"
+
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QRegExp>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+namespace
+{
+
+    //* number of distinct resolution keys
+    const int keyCount = 500;
+
+    //* number of decorations, sharing resolution keys
+    const int decorationCount = 2000;
+
+    //* number of exceptions
+    const int ruleCount = 100;
+
+    //* write exceptions to given configuration. Most are plain class names, the others regular expressions
+    void writeExceptions( KSharedConfig::Ptr config )
+    {
+        Breeze::InternalSettingsList exceptions;
+        for( int i = 0; i < ruleCount; ++i )
+        {
+            Breeze::InternalSettingsPtr exception( new Breeze::InternalSettings() );
+            exception->setOpacityOverride( i%100 );
+            if( i%5 ) {
+                exception->setExceptionPattern( QStringLiteral( "application%1" ).arg( 5*i ) );
+            } else if( i%2 ) {
+                exception->setExceptionPattern( QStringLiteral( "^tool%1\\b" ).arg( 5*i ) );
+            } else {
+                exception->setExceptionType( Breeze::InternalSettings::ExceptionWindowTitle );
+                exception->setExceptionPattern( QStringLiteral( "Document %1 .*" ).arg( 5*i ) );
+            }
+
+            exceptions.append( exception );
+        }
+
+        Breeze::ExceptionList( exceptions ).writeConfig( config );
+        config->sync();
+    }
+
+    //* change animation duration in default settings
+    void setAnimationsDuration( KSharedConfig::Ptr config, int value )
+    {
+        config->group( QStringLiteral( "Windeco" ) ).writeEntry( "AnimationsDuration", value );
+        config->sync();
+    }
+
+    //* decoration, as seen by settings resolution
+    struct Decoration
+    {
+        QString className;
+        QString caption;
+
+        //* settings currently applied, for the previous path
+        Breeze::InternalSettingsPtr internalSettings;
+
+        //* settings currently applied, for the sweep
+        Breeze::DecorationConfigPtr config;
+    };
+
+    //* decorations, cycling through resolution keys
+    QVector<Decoration> createDecorations()
+    {
+        QVector<Decoration> decorations;
+        decorations.reserve( decorationCount );
+        for( int i = 0; i < decorationCount; ++i )
+        {
+            Decoration decoration;
+            const int key = i%keyCount;
+            decoration.className = QStringLiteral( "application%1 Application%1" ).arg( key );
+            decoration.caption = QStringLiteral( "Document %1 - Editor" ).arg( key );
+            decorations.append( decoration );
+        }
+
+        return decorations;
+    }
+
+    //* previous settings provider
+    class InternalSettingsProvider
+    {
+        public:
+
+        //* read default settings and exceptions
+        void reconfigure( KSharedConfig::Ptr config )
+        {
+            if( !m_defaultSettings )
+            {
+                m_defaultSettings = Breeze::InternalSettingsPtr( new Breeze::InternalSettings() );
+                m_defaultSettings->setCurrentGroup( QStringLiteral( "Windeco" ) );
+            }
+
+            m_defaultSettings->load();
+
+            Breeze::ExceptionList exceptions;
+            exceptions.readConfig( config );
+            m_exceptions = exceptions.get();
+        }
+
+        //* first matching exception, matched with QRegExp
+        Breeze::InternalSettingsPtr internalSettings( const Decoration& decoration ) const
+        {
+            for( const Breeze::InternalSettingsPtr& internalSettings : m_exceptions )
+            {
+                if( !internalSettings->enabled() ) continue;
+                if( internalSettings->exceptionPattern().isEmpty() ) continue;
+
+                const QString& value( internalSettings->exceptionType() == Breeze::InternalSettings::ExceptionWindowTitle ?
+                    decoration.caption : decoration.className );
+                if( QRegExp( internalSettings->exceptionPattern() ).indexIn( value ) >= 0 )
+                { return internalSettings; }
+            }
+
+            return m_defaultSettings;
+        }
+
+        private:
+
+        Breeze::InternalSettingsPtr m_defaultSettings;
+        Breeze::InternalSettingsList m_exceptions;
+    };
+
+    //* settings provider sweep, without the decorations
+    class SnapshotProvider
+    {
+        public:
+
+        //* read default settings and exceptions into a new snapshot
+        void reconfigure( KSharedConfig::Ptr config )
+        {
+            if( !m_defaultSettings )
+            {
+                m_defaultSettings = Breeze::InternalSettingsPtr( new Breeze::InternalSettings() );
+                m_defaultSettings->setCurrentGroup( QStringLiteral( "Windeco" ) );
+            }
+
+            m_defaultSettings->load();
+
+            m_snapshot.reset( new Breeze::SettingsSnapshot(
+                Breeze::DecorationConfigPtr( new Breeze::DecorationConfig( *m_defaultSettings ) ),
+                Breeze::ExceptionList::readRules( config ) ) );
+
+            m_resolutions.clear();
+        }
+
+        //* memoised resolution
+        Breeze::DecorationConfigPtr resolve( const Decoration& decoration )
+        {
+            const Breeze::ResolutionKey key( m_snapshot->resolutionKey( decoration.className, decoration.caption, false ) );
+            auto iter = m_resolutions.constFind( key );
+            if( iter != m_resolutions.constEnd() ) return iter.value();
+
+            const Breeze::DecorationConfigPtr config( m_snapshot->resolve( key ) );
+            m_resolutions.insert( key, config );
+            return config;
+        }
+
+        private:
+
+        Breeze::InternalSettingsPtr m_defaultSettings;
+        QScopedPointer<const Breeze::SettingsSnapshot> m_snapshot;
+        QHash<Breeze::ResolutionKey, Breeze::DecorationConfigPtr> m_resolutions;
+    };
+
+    //* number of decoration parts in a config change
+    int partCount( int changes )
+    {
+        int count = 0;
+        for( int bit = 0; bit < Breeze::DecorationConfig::ChangeCount; ++bit )
+        { if( changes & (1<<bit) ) ++count; }
+        return count;
+    }
+
+}
+
+//__________________________________________________________________
+int main( int argc, char** argv )
+{
+
+    // settings are read from and written to a temporary location
+    QTemporaryDir configHome;
+    qputenv( "XDG_CONFIG_HOME", QFile::encodeName( configHome.path() ) );
+
+    QCoreApplication application( argc, argv );
+    QTextStream out( stdout );
+
+    KSharedConfig::Ptr config( KSharedConfig::openConfig( QStringLiteral( "breezerc" ) ) );
+    writeExceptions( config );
+    setAnimationsDuration( config, 150 );
+
+    QVector<Decoration> decorations( createDecorations() );
+    out << decorationCount << " decorations, " << keyCount << " resolution keys, " << ruleCount << " exceptions" << Qt::endl;
+
+    // initial settings
+    InternalSettingsProvider internalSettingsProvider;
+    internalSettingsProvider.reconfigure( config );
+
+    SnapshotProvider snapshotProvider;
+    snapshotProvider.reconfigure( config );
+
+    for( Decoration& decoration : decorations )
+    {
+        decoration.internalSettings = internalSettingsProvider.internalSettings( decoration );
+        decoration.config = snapshotProvider.resolve( decoration );
+    }
+
+    // a single default setting changes
+    setAnimationsDuration( config, 250 );
+
+    QElapsedTimer timer;
+
+    // previous path: all exceptions loaded, then each decoration matched and all its parts applied
+    timer.start();
+    internalSettingsProvider.reconfigure( config );
+    int parts = 0;
+    for( Decoration& decoration : decorations )
+    {
+        decoration.internalSettings = internalSettingsProvider.internalSettings( decoration );
+        parts += partCount( Breeze::DecorationConfig::ChangeAll );
+    }
+
+    out << "per decoration:   " << timer.elapsed() << " ms, " << parts << " parts recomputed" << Qt::endl;
+
+    // sweep: snapshot built once, resolutions memoised per key, changed parts applied
+    timer.start();
+    snapshotProvider.reconfigure( config );
+    parts = 0;
+    for( Decoration& decoration : decorations )
+    {
+        const Breeze::DecorationConfigPtr resolved( snapshotProvider.resolve( decoration ) );
+        parts += partCount( resolved->changes( *decoration.config ) );
+        decoration.config = resolved;
+    }
+
+    out << "batched sweep:    " << timer.elapsed() << " ms, " << parts << " parts recomputed" << Qt::endl;
+
+    return 0;
+
+}
@@ -25,6 +25,10 @@
 
 #include <QSharedPointer>
 #include <QList>
+#include <QLoggingCategory>
+
+//* logging
+Q_DECLARE_LOGGING_CATEGORY(BREEZE)
 
 namespace Breeze
 {
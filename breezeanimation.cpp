@@ -0,0 +1,192 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeanimation.h"
+
+#include <QEasingCurve>
+#include <QTimerEvent>
+
+namespace Breeze
+{
+
+    //* easing curve shared by all animations
+    static const QEasingCurve g_easingCurve( QEasingCurve::InOutQuad );
+
+    //* tick interval (ms)
+    static const int g_tickInterval = 16;
+
+    //__________________________________________________________________
+    Animation::Animation( const Callback& callback ):
+        m_callback( callback )
+    {}
+
+    //__________________________________________________________________
+    Animation::~Animation()
+    {
+        // also covers animations deleted from their own callback, after they finished
+        m_running = false;
+        AnimationDriver::self()->unregisterAnimation( this );
+    }
+
+    //__________________________________________________________________
+    void Animation::start()
+    {
+
+        if( m_duration <= 0 )
+        {
+            // jump to end value
+            m_progress = m_direction == Forward ? 1 : 0;
+            stop();
+            notify();
+            return;
+        }
+
+        m_progress = m_direction == Forward ? 0 : 1;
+        notify();
+
+        if( !m_running )
+        {
+            m_running = true;
+            AnimationDriver::self()->registerAnimation( this );
+        }
+
+    }
+
+    //__________________________________________________________________
+    void Animation::stop()
+    {
+        if( !m_running ) return;
+        m_running = false;
+        AnimationDriver::self()->unregisterAnimation( this );
+    }
+
+    //__________________________________________________________________
+    bool Animation::advance( qint64 elapsed )
+    {
+
+        const qreal step = qreal( elapsed )/m_duration;
+        if( m_direction == Forward ) m_progress = qMin<qreal>( 1, m_progress + step );
+        else m_progress = qMax<qreal>( 0, m_progress - step );
+
+        const bool finished( m_direction == Forward ? m_progress >= 1 : m_progress <= 0 );
+        if( finished ) m_running = false;
+
+        notify();
+        return !finished;
+
+    }
+
+    //__________________________________________________________________
+    void Animation::notify() const
+    { if( m_callback ) m_callback( g_easingCurve.valueForProgress( m_progress ) ); }
+
+    //__________________________________________________________________
+    AnimationDriver *AnimationDriver::s_self = nullptr;
+
+    //__________________________________________________________________
+    AnimationDriver::AnimationDriver()
+    {}
+
+    //__________________________________________________________________
+    AnimationDriver::~AnimationDriver()
+    { s_self = nullptr; }
+
+    //__________________________________________________________________
+    AnimationDriver *AnimationDriver::self()
+    {
+        if( !s_self )
+        { s_self = new AnimationDriver(); }
+
+        return s_self;
+    }
+
+    //__________________________________________________________________
+    void AnimationDriver::registerAnimation( Animation* animation )
+    {
+        if( m_animations.contains( animation ) ) return;
+        m_animations.append( animation );
+
+        if( !m_timer.isActive() )
+        {
+            m_clock.start();
+            m_timer.start( g_tickInterval, Qt::PreciseTimer, this );
+        }
+    }
+
+    //__________________________________________________________________
+    void AnimationDriver::unregisterAnimation( Animation* animation )
+    {
+        const int index = m_animations.indexOf( animation );
+        if( index < 0 ) return;
+
+        if( m_ticking )
+        {
+
+            // compacted once all animations are advanced
+            m_animations[index] = nullptr;
+            ++m_removed;
+
+        } else {
+
+            m_animations.remove( index );
+            if( m_animations.isEmpty() ) m_timer.stop();
+
+        }
+    }
+
+    //__________________________________________________________________
+    void AnimationDriver::timerEvent( QTimerEvent* event )
+    {
+
+        if( event->timerId() != m_timer.timerId() )
+        { return QObject::timerEvent( event ); }
+
+        const qint64 elapsed = m_clock.restart();
+
+        // advance all animations in one pass. Repaints requested from the callbacks
+        // are merged by the decoration into a single update per frame
+        m_ticking = true;
+        const int count = m_animations.size();
+        for( int i = 0; i < count; ++i )
+        {
+            Animation* animation = m_animations[i];
+            if( !animation ) continue;
+
+            animation->advance( elapsed );
+
+            // animation might have been deleted or restarted from its callback
+            if( m_animations[i] == animation && !animation->isRunning() )
+            {
+                m_animations[i] = nullptr;
+                ++m_removed;
+            }
+        }
+        m_ticking = false;
+
+        // compact
+        if( m_removed > 0 )
+        {
+            m_animations.removeAll( nullptr );
+            m_removed = 0;
+        }
+
+        if( m_animations.isEmpty() ) m_timer.stop();
+
+    }
+
+}
@@ -0,0 +1,162 @@
+#ifndef breezeanimation_h
+#define breezeanimation_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QBasicTimer>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QVector>
+
+#include <functional>
+
+namespace Breeze
+{
+
+    //* lightweight opacity transition from 0 to 1, advanced by the shared AnimationDriver
+    class Animation
+    {
+
+        public:
+
+        //* receives eased value for each step
+        using Callback = std::function<void(qreal)>;
+
+        //* direction
+        enum Direction
+        {
+            Forward,
+            Backward
+        };
+
+        //* constructor
+        explicit Animation( const Callback& );
+
+        //* destructor
+        ~Animation();
+
+        //*@name accessors
+        //@{
+
+        int duration() const
+        { return m_duration; }
+
+        Direction direction() const
+        { return m_direction; }
+
+        bool isRunning() const
+        { return m_running; }
+
+        //@}
+
+        //*@name modifiers
+        //@{
+
+        void setDuration( int value )
+        { m_duration = value; }
+
+        //* change direction. A running animation continues from its current progress
+        void setDirection( Direction value )
+        { m_direction = value; }
+
+        //* start from the beginning, depending on direction
+        void start();
+
+        //* stop, leaving value unchanged
+        void stop();
+
+        //@}
+
+        private:
+
+        //* advance by given time, in milliseconds. Returns false when finished
+        bool advance( qint64 );
+
+        //* notify current value
+        void notify() const;
+
+        Callback m_callback;
+        int m_duration = 0;
+        Direction m_direction = Forward;
+        bool m_running = false;
+
+        //* linear progress, in [0,1]
+        qreal m_progress = 0;
+
+        friend class AnimationDriver;
+
+    };
+
+    //* single clock advancing all running animations
+    class AnimationDriver: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* destructor
+        ~AnimationDriver();
+
+        //* singleton
+        static AnimationDriver *self();
+
+        //* register running animation, starts the clock if needed
+        void registerAnimation( Animation* );
+
+        //* unregister animation, stops the clock when idle
+        void unregisterAnimation( Animation* );
+
+        //* number of running animations
+        int count() const
+        { return m_animations.count() - m_removed; }
+
+        protected:
+
+        //* advance all running animations
+        void timerEvent( QTimerEvent* ) override;
+
+        private:
+
+        //* constructor
+        AnimationDriver();
+
+        //* running animations
+        QVector<Animation*> m_animations;
+
+        //* number of animations unregistered while ticking
+        int m_removed = 0;
+
+        //* true while advancing animations
+        bool m_ticking = false;
+
+        //* tick timer, only active while animations are running
+        QBasicTimer m_timer;
+
+        //* time since last tick
+        QElapsedTimer m_clock;
+
+        //* singleton
+        static AnimationDriver *s_self;
+
+    };
+
+}
+
+#endif
@@ -19,9 +19,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "breezebutton.h"
+#include "breezepaintgovernor.h"
 
 #include <KDecoration2/DecoratedClient>
-#include <KColorUtils>
 
 #include <QPainter>
 #include <QPainterPath>
@@ -37,16 +37,8 @@ namespace Breeze
     //__________________________________________________________________
     Button::Button(DecorationButtonType type, Decoration* decoration, QObject* parent)
         : DecorationButton(type, decoration, parent)
-        , m_animation( new QPropertyAnimation( this ) )
     {
 
-        // setup animation
-        m_animation->setStartValue( 0 );
-        m_animation->setEndValue( 1.0 );
-        m_animation->setTargetObject( this );
-        m_animation->setPropertyName( "opacity" );
-        m_animation->setEasingCurve( QEasingCurve::InOutQuad );
-
         // setup default geometry
         const int height = decoration->buttonHeight();
         const int width = height * (type == DecorationButtonType::Menu ? 1.0 : 1.5);
@@ -54,14 +46,27 @@ namespace Breeze
         setIconSize(QSize( width, height ));
 
         // connections
-        connect(decoration->client().data(), SIGNAL(iconChanged(QIcon)), this, SLOT(update()));
-        connect(decoration->settings().data(), &KDecoration2::DecorationSettings::reconfigured, this, &Button::reconfigure);
+        if( type == DecorationButtonType::Menu )
+        { connect(decoration->client().data(), &KDecoration2::DecoratedClient::iconChanged, this, &Button::updateApplicationIcon); }
+
         connect( this, &KDecoration2::DecorationButton::hoveredChanged, this, &Button::updateAnimationState );
 
-        reconfigure();
+        // buttons are part of the cached title bars
+        connect( this, &KDecoration2::DecorationButton::hoveredChanged, decoration, &Decoration::updateButtonState );
+        connect( this, &KDecoration2::DecorationButton::pressedChanged, decoration, &Decoration::updateButtonState );
+        connect( this, &KDecoration2::DecorationButton::checkedChanged, decoration, &Decoration::updateButtonState );
+        connect( this, &KDecoration2::DecorationButton::visibilityChanged, decoration, &Decoration::updateButtonState );
 
     }
 
+    //__________________________________________________________________
+    Button::~Button()
+    {
+        // icons that are not themed are specific to this window
+        if( m_applicationIconKey.name.isEmpty() && m_applicationIconKey.cacheKey != 0 )
+        { IconAtlas::self()->removeApplicationIcon( m_applicationIconKey ); }
+    }
+
     //__________________________________________________________________
     Button::Button(QObject *parent, const QVariantList &args)
         : Button(args.at(0).value<DecorationButtonType>(), args.at(1).value<Decoration*>(), parent)
@@ -106,10 +111,6 @@ namespace Breeze
                 QObject::connect(d->client().data(), &KDecoration2::DecoratedClient::shadeableChanged, b, &Breeze::Button::setVisible );
                 break;
 
-                case DecorationButtonType::Menu:
-                QObject::connect(d->client().data(), &KDecoration2::DecoratedClient::iconChanged, b, [b]() { b->update(); });
-                break;
-
                 default: break;
 
             }
@@ -145,11 +146,63 @@ namespace Breeze
             const qreal topLeft = (geometry().width()/2) - (menuIconSize/2);
 
             const QRectF iconRect(topLeft + geometry().left(), topLeft + geometry().top(), menuIconSize, menuIconSize);
-            decoration()->client().data()->icon().paint(painter, iconRect.toRect());
+
+            // application icon is shared by all windows of the same application
+            const QIcon icon( decoration()->client().data()->icon() );
+            const qreal devicePixelRatio( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+            m_applicationIconKey = IconAtlas::applicationIconKey( icon, menuIconSize, devicePixelRatio );
+            painter->drawPixmap( iconRect.topLeft(), IconAtlas::self()->applicationIcon( icon, m_applicationIconKey ) );
 
         } else {
 
-            drawIcon( painter );
+            auto d = qobject_cast<Decoration*>( decoration() );
+
+            // colors
+            const QColor foregroundColor( this->foregroundColor() );
+            const QColor backgroundColor( this->backgroundColor() );
+
+            // center dot of the checked on-all-desktops glyph falls back to the title bar color
+            QColor fallbackColor;
+            if( type() == DecorationButtonType::OnAllDesktops && isChecked() && !backgroundColor.isValid() )
+            {
+                if( d ) fallbackColor = d->titleBarColor();
+            }
+
+            const bool antialiased( PaintGovernor::self()->glyphAntialiasing() );
+
+            // colors change on every animation frame, such glyphs would only pollute the atlas
+            if( isAnimated() || ( d && d->hasAnimatedColors() ) )
+            {
+                painter->translate( geometry().topLeft() );
+                drawIcon( painter, foregroundColor, backgroundColor, fallbackColor, antialiased );
+                painter->restore();
+                return;
+            }
+
+            // lookup pre-rendered glyph
+            const qreal devicePixelRatio( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+            const IconAtlas::Key key = {
+                type(), isChecked(), antialiased,
+                foregroundColor.isValid() ? foregroundColor.rgba() : 0,
+                backgroundColor.isValid() ? backgroundColor.rgba() : 0,
+                fallbackColor.isValid() ? fallbackColor.rgba() : 0,
+                m_iconSize, devicePixelRatio };
+
+            QPixmap pixmap( IconAtlas::self()->pixmap( key ) );
+            if( pixmap.isNull() )
+            {
+                pixmap = QPixmap( m_iconSize*devicePixelRatio );
+                pixmap.setDevicePixelRatio( devicePixelRatio );
+                pixmap.fill( Qt::transparent );
+
+                QPainter pixmapPainter( &pixmap );
+                drawIcon( &pixmapPainter, foregroundColor, backgroundColor, fallbackColor, antialiased );
+                pixmapPainter.end();
+
+                IconAtlas::self()->insert( key, pixmap );
+            }
+
+            painter->drawPixmap( geometry().topLeft(), pixmap );
 
         }
 
@@ -158,44 +211,22 @@ namespace Breeze
     }
 
     //__________________________________________________________________
-    void Button::drawIcon( QPainter *painter ) const
+    void Button::drawIcon( QPainter *painter, const QColor& foregroundColor, const QColor& backgroundColor, const QColor& fallbackColor, bool antialiased ) const
     {
 
-        painter->setRenderHints( QPainter::Antialiasing );
+        painter->setRenderHint( QPainter::Antialiasing, antialiased );
 
         /*
         scale painter so that its window matches QRect( 0, 0, 45, 30 )
         this makes all further rendering and scaling simpler
         all further rendering is preformed inside QRect( 0, 0, 45, 30 )
         */
-        painter->translate( geometry().topLeft() );
-
         const qreal height( m_iconSize.height() );
         const qreal width( m_iconSize.width() );
         if ( height != 30 )
             painter->scale( width/45, height/30 );
 
-        // render background
-        const QColor backgroundColor( this->backgroundColor() );
-
-        auto d = qobject_cast<Decoration*>( decoration() );
-        bool isInactive(d && !d->client().data()->isActive()
-                        && !isHovered() && !isPressed()
-                        && m_animation->state() != QPropertyAnimation::Running);
-        QColor inactiveCol(Qt::gray);
-        if (isInactive)
-        {
-            int gray = qGray(d->titleBarColor().rgb());
-            if (gray <= 200) {
-                gray += 55;
-                gray = qMax(gray, 115);
-            }
-            else gray -= 45;
-            inactiveCol = QColor(gray, gray, gray);
-        }
-
         // render mark
-        const QColor foregroundColor( this->foregroundColor() );
         if( foregroundColor.isValid() )
         {
 
@@ -285,12 +316,10 @@ namespace Breeze
                         painter->drawRect( QRectF( 16, 9, 12, 12 ) );
 
                         // center dot
-                        QColor backgroundColor( this->backgroundColor() );
-                        if( !backgroundColor.isValid() && d ) backgroundColor = d->titleBarColor();
-
-                        if( backgroundColor.isValid() )
+                        const QColor dotColor( backgroundColor.isValid() ? backgroundColor : fallbackColor );
+                        if( dotColor.isValid() )
                         {
-                            painter->setBrush( backgroundColor );
+                            painter->setBrush( dotColor );
                             painter->drawRect( QRectF( 21, 14, 2, 2 ) );
                         }
 
@@ -441,13 +470,16 @@ namespace Breeze
 
             return QColor();
 
-        } else if( ( type() == DecorationButtonType::KeepBelow || type() == DecorationButtonType::KeepAbove ) && isChecked() ) {
+        }
 
-            return d->titleBarColor();
+        const ColorSet colors( d->colors() );
+        if( ( type() == DecorationButtonType::KeepBelow || type() == DecorationButtonType::KeepAbove ) && isChecked() ) {
 
-        } else if( m_animation->state() == QPropertyAnimation::Running && type() == DecorationButtonType::Close ) {
+            return colors.titleBar;
 
-            return KColorUtils::mix( d->fontColor(), Qt::white, m_opacity );
+        } else if( isAnimated() && type() == DecorationButtonType::Close ) {
+
+            return d->palette().ramps.closeForeground[ d->hasActiveColors() ].at( m_opacity );
 
         } else if( isHovered() && type() == DecorationButtonType::Close ) {
 
@@ -455,7 +487,7 @@ namespace Breeze
 
         } else {
 
-            return d->fontColor();
+            return colors.font;
 
         }
 
@@ -471,21 +503,22 @@ namespace Breeze
 
         }
 
+        const ColorSet colors( d->colors() );
         if( isPressed() ) {
 
-            if( type() == DecorationButtonType::Close ) return KColorUtils::mix( Qt::red, Qt::black, 0.3 );
-            else return KColorUtils::mix( d->titleBarColor(), d->fontColor(), 0.3 );
+            if( type() == DecorationButtonType::Close ) return d->palette().closePressed;
+            else return colors.pressed;
 
         } else if( ( type() == DecorationButtonType::KeepBelow || type() == DecorationButtonType::KeepAbove ) && isChecked() ) {
 
-            return d->fontColor();
+            return colors.font;
 
-        } else if( m_animation->state() == QPropertyAnimation::Running ) {
+        } else if( isAnimated() ) {
 
-            if( type() == DecorationButtonType::Close ) return KColorUtils::mix( d->titleBarColor(), Qt::red, m_opacity );
+            if( type() == DecorationButtonType::Close ) return d->palette().ramps.closeBackground[ d->hasActiveColors() ].at( m_opacity );
             else {
 
-                QColor color( KColorUtils::mix( d->titleBarColor(), d->fontColor(), 0.2 ) );
+                QColor color( colors.hover );
                 color.setAlpha( color.alpha()*m_opacity );
                 return color;
 
@@ -493,8 +526,8 @@ namespace Breeze
 
         } else if( isHovered() ) {
 
-            if( type() == DecorationButtonType::Close ) return Qt::red;
-            else return KColorUtils::mix( d->titleBarColor(), d->fontColor(), 0.2 );
+            if( type() == DecorationButtonType::Close ) return d->palette().closeHover;
+            else return colors.hover;
 
         } else {
 
@@ -505,12 +538,16 @@ namespace Breeze
     }
 
     //________________________________________________________________
-    void Button::reconfigure()
+    void Button::updateApplicationIcon()
     {
 
-        // animation
-        auto d = qobject_cast<Decoration*>(decoration());
-        if( d )  m_animation->setDuration( d->internalSettings()->animationsDuration() );
+        // per window icons are stale now, themed ones are shared and left to expire
+        if( m_applicationIconKey.name.isEmpty() && m_applicationIconKey.cacheKey != 0 )
+        { IconAtlas::self()->removeApplicationIcon( m_applicationIconKey ); }
+
+        m_applicationIconKey = IconAtlas::ApplicationIconKey();
+        if( auto d = qobject_cast<Decoration*>( decoration() ) ) d->invalidateTitleBarCache();
+        update();
 
     }
 
@@ -519,13 +556,23 @@ namespace Breeze
     {
 
         auto d = qobject_cast<Decoration*>(decoration());
-        if( !(d && d->internalSettings()->animationsEnabled() ) ) return;
+        if( !(d && d->config().animationsEnabled && PaintGovernor::self()->animationsAllowed() ) ) return;
+
+        // animation is only allocated on first hover
+        if( !m_animation )
+        {
+            if( !hovered ) return;
+            m_animation.reset( new Animation( [this]( qreal value ) { setOpacity( value ); } ) );
+        }
+
+        // duration is read from the decoration settings, shared by all buttons
+        m_animation->setDuration( d->config().animationsDuration );
 
-        QAbstractAnimation::Direction dir = hovered ? QPropertyAnimation::Forward : QPropertyAnimation::Backward;
-        if( m_animation->state() == QPropertyAnimation::Running && m_animation->direction() != dir )
+        const Animation::Direction dir = hovered ? Animation::Forward : Animation::Backward;
+        if( m_animation->isRunning() && m_animation->direction() != dir )
             m_animation->stop();
         m_animation->setDirection( dir );
-        if( m_animation->state() != QPropertyAnimation::Running ) m_animation->start();
+        if( !m_animation->isRunning() ) m_animation->start();
 
     }
 
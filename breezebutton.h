@@ -22,11 +22,13 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include <KDecoration2/DecorationButton>
+#include "breezeanimation.h"
 #include "breezedecoration.h"
+#include "breezeiconatlas.h"
 
 #include <QHash>
 #include <QImage>
-#include <QPropertyAnimation>
+#include <QScopedPointer>
 
 namespace Breeze
 {
@@ -35,16 +37,13 @@ namespace Breeze
     {
         Q_OBJECT
 
-        //* declare active state opacity
-        Q_PROPERTY( qreal opacity READ opacity WRITE setOpacity )
-
         public:
 
         //* constructor
         explicit Button(QObject *parent, const QVariantList &args);
 
         //* destructor
-        virtual ~Button() = default;
+        virtual ~Button();
 
         //* button creation
         static Button *create(KDecoration2::DecorationButtonType type, KDecoration2::Decoration *decoration, QObject *parent);
@@ -100,19 +99,23 @@ namespace Breeze
 
         private Q_SLOTS:
 
-        //* apply configuration changes
-        void reconfigure();
-
         //* animation state
         void updateAnimationState(bool);
 
+        //* drop cached application icon
+        void updateApplicationIcon();
+
         private:
 
         //* private constructor
         explicit Button(KDecoration2::DecorationButtonType type, Decoration *decoration, QObject *parent = nullptr);
 
+        //* true if hover animation is running
+        bool isAnimated() const
+        { return m_animation && m_animation->isRunning(); }
+
         //* draw button icon
-        void drawIcon( QPainter *) const;
+        void drawIcon( QPainter*, const QColor& foreground, const QColor& background, const QColor& fallback, bool antialiased ) const;
 
         //*@name colors
         //@{
@@ -122,8 +125,8 @@ namespace Breeze
 
         Flag m_flag = FlagNone;
 
-        //* active state change animation
-        QPropertyAnimation *m_animation;
+        //* hover animation, allocated on first hover
+        QScopedPointer<Animation> m_animation;
 
         //* vertical offset (for rendering)
         QPointF m_offset;
@@ -131,6 +134,9 @@ namespace Breeze
         //* icon size
         QSize m_iconSize;
 
+        //* cached application icon, for menu button
+        IconAtlas::ApplicationIconKey m_applicationIconKey;
+
         //* active state change opacity
         qreal m_opacity = 0;
     };
@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezecaption.h"
+
+namespace Breeze
+{
+
+    //* true for explicit bidirectional embeddings, overrides, isolates and their terminators
+    static bool isBidiControl( QChar character )
+    {
+        const ushort unicode( character.unicode() );
+        return ( unicode >= 0x202a && unicode <= 0x202e ) || ( unicode >= 0x2066 && unicode <= 0x2069 );
+    }
+
+    //__________________________________________________________________
+    QString sanitizeCaption( const QString& caption, int maxLength )
+    {
+        QString source( caption );
+        if( source.size() > maxLength )
+        {
+            int headLength = maxLength/2;
+            int tailLength = maxLength - headLength;
+            if( source.at( headLength - 1 ).isHighSurrogate() ) --headLength;
+            if( source.at( source.size() - tailLength ).isLowSurrogate() ) --tailLength;
+            source = source.left( headLength ) + QChar( 0x2026 ) + source.right( tailLength );
+        }
+
+        QString out;
+        out.reserve( source.size() );
+        for( const QChar& character : source )
+        {
+            if( isBidiControl( character ) ) continue;
+            else if( character.category() != QChar::Other_Control ) out.append( character );
+            else if( character.isSpace() ) out.append( QLatin1Char( ' ' ) );
+        }
+
+        return out;
+    }
+
+    //__________________________________________________________________
+    QString CaptionLayout::elidedCaption( const QFontMetrics& metrics, int width )
+    {
+        if( fullWidth < 0 ) fullWidth = metrics.horizontalAdvance( caption );
+
+        // whole caption fits
+        if( width >= fullWidth ) return caption;
+
+        /*
+        the elided text for a given width also fits any smaller width down to its own advance,
+        and is still the longest candidate there, so it only needs recomputing
+        outside of the [elidedWidth, maxWidth] range
+        */
+        if( maxWidth >= 0 && width >= elidedWidth && width <= maxWidth )
+        { return elided; }
+
+        const QString text( metrics.elidedText( caption, Qt::ElideMiddle, width ) );
+        if( text == elided && width > maxWidth && maxWidth >= 0 )
+        {
+
+            // same glyph boundary, extend valid range
+            maxWidth = width;
+
+        } else {
+
+            elided = text;
+            elidedWidth = metrics.horizontalAdvance( text );
+            maxWidth = width;
+
+        }
+
+        return elided;
+    }
+
+}
@@ -0,0 +1,63 @@
+#ifndef breezecaption_h
+#define breezecaption_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QFontMetrics>
+#include <QRect>
+#include <QString>
+
+namespace Breeze
+{
+
+    //* caption with control and bidirectional formatting characters removed, and at most maxLength characters
+    /**
+    longer captions keep their head and tail, so that middle elision is unchanged.
+    Explicit embeddings, overrides and isolates are removed rather than balanced,
+    so that a title cannot reorder or hide the text around it
+    */
+    QString sanitizeCaption( const QString& caption, int maxLength );
+
+    //* caption layout, reused across width changes
+    struct CaptionLayout
+    {
+        //* caption being displayed, sanitized
+        QString caption;
+
+        //* client width used to bound caption length
+        int width = 0;
+
+        bool boundingRectValid = false;
+        QRect boundingRect;
+
+        //* full caption advance, -1 if not computed
+        int fullWidth = -1;
+
+        //* elided caption and the range of widths for which it is valid
+        QString elided;
+        int elidedWidth = 0;
+        int maxWidth = -1;
+
+        //* caption elided to given width, computed again only outside of the range the last one is valid for
+        QString elidedCaption( const QFontMetrics&, int width );
+    };
+
+}
+
+#endif
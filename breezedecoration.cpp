@@ -27,6 +27,8 @@
 #include "config/breezeconfigwidget.h"
 
 #include "breezebutton.h"
+#include "breezeiconatlas.h"
+#include "breezepaintgovernor.h"
 #include "breezesizegrip.h"
 
 #include "breezeboxshadowrenderer.h"
@@ -40,8 +42,10 @@
 #include <KColorUtils>
 #include <KSharedConfig>
 #include <KPluginFactory>
+#include <KWindowInfo>
 
 #include <QPainter>
+#include <QStringList>
 #include <QTextStream>
 #include <QTimer>
 
@@ -140,8 +144,28 @@ namespace
             return s_shadowParams[3];
         }
     }
+
+    //* minimum number of caption characters kept, regardless of title bar width
+    const int s_minCaptionLength = 512;
+
+    //* readable list of config changes, for logging
+    QStringList changeNames( int changes )
+    {
+        using Breeze::DecorationConfig;
+        QStringList names;
+        if( changes & DecorationConfig::ChangeBorders ) names.append( QStringLiteral( "borders" ) );
+        if( changes & DecorationConfig::ChangeTitleLayout ) names.append( QStringLiteral( "title layout" ) );
+        if( changes & DecorationConfig::ChangeColors ) names.append( QStringLiteral( "colors" ) );
+        if( changes & DecorationConfig::ChangeShadow ) names.append( QStringLiteral( "shadow" ) );
+        if( changes & DecorationConfig::ChangeAnimation ) names.append( QStringLiteral( "animation" ) );
+        if( changes & DecorationConfig::ChangeSizeGrip ) names.append( QStringLiteral( "size grip" ) );
+        if( names.isEmpty() ) names.append( QStringLiteral( "nothing" ) );
+        return names;
+    }
 }
 
+Q_LOGGING_CATEGORY(BREEZE, "breeze10.decoration", QtWarningMsg)
+
 namespace Breeze
 {
 
@@ -159,7 +183,7 @@ namespace Breeze
     //________________________________________________________________
     Decoration::Decoration(QObject *parent, const QVariantList &args)
         : KDecoration2::Decoration(parent, args)
-        , m_animation( new QPropertyAnimation( this ) )
+        , m_animation( new Animation( [this]( qreal value ) { updateActivationOpacity( value ); } ) )
     {
         g_sDecoCount++;
     }
@@ -167,6 +191,8 @@ namespace Breeze
     //________________________________________________________________
     Decoration::~Decoration()
     {
+        SettingsProvider::self()->unregisterDecoration( this );
+
         g_sDecoCount--;
         if (g_sDecoCount == 0) {
             // last deco destroyed, clean up shadow
@@ -187,34 +213,126 @@ namespace Breeze
         if( m_sizeGrip ) m_sizeGrip->update();
     }
 
+    //________________________________________________________________
+    void Decoration::updateActivationOpacity( qreal value )
+    {
+        setOpacity( value );
+
+        // cached title bars are only needed while crossfading, unless the governor paints from them
+        if( !m_animation->isRunning() && !PaintGovernor::self()->cachedOnly() )
+        { m_titleBarCache = TitleBarCache(); }
+    }
+
+    //________________________________________________________________
+    void ColorRamp::build( const QColor& first, const QColor& second )
+    {
+        for( int i = 0; i < Size; ++i )
+        { m_colors[i] = KColorUtils::mix( first, second, qreal( i )/( Size - 1 ) ).rgba(); }
+    }
+
+    //________________________________________________________________
+    bool Decoration::hasActiveColors() const
+    {
+        if( m_forcedColorGroup != ForcedNone ) return m_forcedColorGroup == ForcedActive;
+        else return client().data()->isActive();
+    }
+
+    //________________________________________________________________
+    bool Decoration::hasAnimatedColors() const
+    { return m_forcedColorGroup == ForcedNone && m_animation->isRunning(); }
+
     //________________________________________________________________
     QColor Decoration::titleBarColor() const
     {
 
-        auto c = client().data();
-        if( hideTitleBar() ) return c->color( ColorGroup::Inactive, ColorRole::TitleBar );
-        else if( m_animation->state() == QPropertyAnimation::Running )
-        {
-            return KColorUtils::mix(
-                c->color( ColorGroup::Inactive, ColorRole::TitleBar ),
-                c->color( ColorGroup::Active, ColorRole::TitleBar ),
-                m_opacity );
-        } else return c->color( c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::TitleBar );
+        if( hideTitleBar() ) return m_palette.inactive.titleBar;
+        else if( hasAnimatedColors() ) return m_palette.ramps.titleBar.at( m_opacity );
+        else return hasActiveColors() ? m_palette.active.titleBar : m_palette.inactive.titleBar;
 
     }
 
     //________________________________________________________________
     QColor Decoration::fontColor() const
+    {
+
+        if( hasAnimatedColors() ) return m_palette.ramps.font.at( m_opacity );
+        else return hasActiveColors() ? m_palette.active.font : m_palette.inactive.font;
+
+    }
+
+    //________________________________________________________________
+    ColorSet Decoration::colors() const
+    {
+
+        const bool active( hasActiveColors() );
+        if( hasAnimatedColors() )
+        {
+            ColorSet colors;
+            colors.titleBar = titleBarColor();
+            colors.font = fontColor();
+            if( hideTitleBar() ) colors.frame = active ? m_palette.hiddenTitleBarFrame : m_palette.inactive.frame;
+            else colors.frame = m_palette.ramps.frame.at( m_opacity );
+            colors.outline = active ? m_palette.active.outline : m_palette.inactive.outline;
+            colors.hover = m_palette.ramps.hover.at( m_opacity );
+            colors.pressed = m_palette.ramps.pressed.at( m_opacity );
+            return colors;
+
+        } else {
+
+            ColorSet colors( active ? m_palette.active : m_palette.inactive );
+            if( hideTitleBar() )
+            {
+                colors.titleBar = m_palette.inactive.titleBar;
+                colors.frame = active ? m_palette.hiddenTitleBarFrame : m_palette.inactive.frame;
+            }
+
+            return colors;
+
+        }
+
+    }
+
+    //________________________________________________________________
+    void Decoration::updatePalette()
     {
 
         auto c = client().data();
-        if( m_animation->state() == QPropertyAnimation::Running )
+        for( const auto group : { ColorGroup::Active, ColorGroup::Inactive } )
         {
-            return KColorUtils::mix(
-                c->color( ColorGroup::Inactive, ColorRole::Foreground ),
-                c->color( ColorGroup::Active, ColorRole::Foreground ),
-                m_opacity );
-        } else return  c->color( c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::Foreground );
+            ColorSet& colors( group == ColorGroup::Active ? m_palette.active : m_palette.inactive );
+            colors.titleBar = c->color( group, ColorRole::TitleBar );
+            colors.font = c->color( group, ColorRole::Foreground );
+            colors.frame = group == ColorGroup::Active ? KColorUtils::mix( colors.titleBar, Qt::black, 0.3 ) : colors.titleBar;
+            colors.outline = group == ColorGroup::Active ? colors.titleBar : colors.font;
+            colors.hover = KColorUtils::mix( colors.titleBar, colors.font, 0.2 );
+            colors.pressed = KColorUtils::mix( colors.titleBar, colors.font, 0.3 );
+        }
+
+        m_palette.closeHover = Qt::red;
+        m_palette.closePressed = KColorUtils::mix( Qt::red, Qt::black, 0.3 );
+        m_palette.hiddenTitleBarFrame = KColorUtils::mix( m_palette.inactive.titleBar, Qt::black, 0.3 );
+        m_palette.titleBarAlpha = settings()->isAlphaChannelSupported() ? titleBarAlpha() : 255;
+        updateOpaque();
+
+        // animation ramps
+        ColorRamps& ramps( m_palette.ramps );
+        ramps.titleBar.build( m_palette.inactive.titleBar, m_palette.active.titleBar );
+        ramps.font.build( m_palette.inactive.font, m_palette.active.font );
+        ramps.frame.build( m_palette.inactive.frame, m_palette.active.frame );
+        ramps.hover.build( m_palette.inactive.hover, m_palette.active.hover );
+        ramps.pressed.build( m_palette.inactive.pressed, m_palette.active.pressed );
+
+        const ColorSet* groups[2] = { &m_palette.inactive, &m_palette.active };
+        for( int i = 0; i < 2; ++i )
+        {
+            ramps.closeBackground[i].build( groups[i]->titleBar, m_palette.closeHover );
+            ramps.closeForeground[i].build( groups[i]->font, Qt::white );
+        }
+
+        // cached title bars use the previous colors
+        m_titleBarCache = TitleBarCache();
+
+        update();
 
     }
 
@@ -223,53 +341,64 @@ namespace Breeze
     {
         auto c = client().data();
 
-        // active state change animation
-        m_animation->setStartValue( 0 );
-        m_animation->setEndValue( 1.0 );
-        m_animation->setTargetObject( this );
-        m_animation->setPropertyName( "opacity" );
-        m_animation->setEasingCurve( QEasingCurve::InOutQuad );
+        // trailing caption update when caption repaint rate is exceeded
+        m_captionTimer = new QTimer( this );
+        m_captionTimer->setSingleShot( true );
+        connect( m_captionTimer, &QTimer::timeout, this, &Decoration::flushCaption );
+
+        // full relayout once an interactive resize settles
+        m_resizeTimer = new QTimer( this );
+        m_resizeTimer->setSingleShot( true );
+        m_resizeTimer->setInterval( 150 );
+        connect( m_resizeTimer, &QTimer::timeout, this,
+            [this]()
+            {
+                // caption might have been truncated for a narrower window
+                if( client().data()->width() > m_captionLayout.width ) resetCaptionLayout();
+                scheduleUpdate( UpdateTitleBar|UpdateButtons );
+            }
+        );
 
-        reconfigure();
+        // further reconfigurations are applied by the settings provider, to all decorations at once
+        SettingsProvider::self()->registerDecoration( this );
+        updateConfig();
         updateTitleBar();
         auto s = settings();
-        connect(s.data(), &KDecoration2::DecorationSettings::borderSizeChanged, this, &Decoration::recalculateBorders);
+        connect(s.data(), &KDecoration2::DecorationSettings::borderSizeChanged, this, [this]() { scheduleUpdate( UpdateBorders ); updateSizeGrip(); });
 
         // a change in font might cause the borders to change
         recalculateBorders();
-        connect(s.data(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::recalculateBorders);
+        connect(s.data(), &KDecoration2::DecorationSettings::spacingChanged, this, [this]() { scheduleUpdate( UpdateBorders|UpdateButtons ); });
 
         // buttons
-        connect(s.data(), &KDecoration2::DecorationSettings::spacingChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsLeftChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.data(), &KDecoration2::DecorationSettings::decorationButtonsRightChanged, this, &Decoration::updateButtonsGeometryDelayed);
 
         // full reconfiguration
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
         connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection );
-        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, this, &Decoration::updateButtonsGeometryDelayed);
+        connect(s.data(), &KDecoration2::DecorationSettings::reconfigured, IconAtlas::self(), &IconAtlas::clear, Qt::UniqueConnection );
 
-        connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::recalculateBorders);
-        connect(c, &KDecoration2::DecoratedClient::maximizedHorizontallyChanged, this, &Decoration::recalculateBorders);
-        connect(c, &KDecoration2::DecoratedClient::maximizedVerticallyChanged, this, &Decoration::recalculateBorders);
-        connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::recalculateBorders);
-        connect(c, &KDecoration2::DecoratedClient::captionChanged, this,
-            [this]()
-            {
-                // update the caption area
-                update(titleBar());
-            }
-        );
+        // paint quality changes how glyphs and cached title bars are rendered
+        connect(PaintGovernor::self(), &PaintGovernor::levelChanged, IconAtlas::self(), &IconAtlas::clear, Qt::UniqueConnection );
+        connect(PaintGovernor::self(), &PaintGovernor::levelChanged, this, [this]() { invalidateTitleBarCache(); update(); });
 
-        connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateAnimationState);
-        connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateTitleBar);
-        connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateTitleBar);
-        //connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::setOpaque);
+        // palette snapshot depends on the client palette. Glyph colors are part of the atlas key
+        connect(c, &KDecoration2::DecoratedClient::paletteChanged, this, &Decoration::updatePalette);
+
+        // title bar alpha is ignored without compositing
+        connect(s.data(), &KDecoration2::DecorationSettings::alphaChannelSupportedChanged, this, &Decoration::updatePalette);
 
-        connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateButtonsGeometry);
-        connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, &Decoration::updateButtonsGeometry);
-        connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
-        connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, &Decoration::updateButtonsGeometry);
+        // geometry changes are collected and resolved once per event loop iteration
+        connect(c, &KDecoration2::DecoratedClient::adjacentScreenEdgesChanged, this, [this]() { scheduleUpdate( UpdateBorders|UpdateButtons ); });
+        connect(c, &KDecoration2::DecoratedClient::maximizedHorizontallyChanged, this, [this]() { scheduleUpdate( UpdateBorders ); });
+        connect(c, &KDecoration2::DecoratedClient::maximizedVerticallyChanged, this, [this]() { scheduleUpdate( UpdateBorders ); });
+        connect(c, &KDecoration2::DecoratedClient::shadedChanged, this, [this]() { scheduleUpdate( UpdateBorders|UpdateButtons ); });
+        connect(c, &KDecoration2::DecoratedClient::captionChanged, this, &Decoration::updateCaption);
+        connect(c, &KDecoration2::DecoratedClient::captionChanged, this, &Decoration::updateTitleExceptions);
+
+        connect(c, &KDecoration2::DecoratedClient::activeChanged, this, &Decoration::updateAnimationState);
+        connect(c, &KDecoration2::DecoratedClient::widthChanged, this, &Decoration::updateWidth);
+        connect(c, &KDecoration2::DecoratedClient::maximizedChanged, this, [this]() { scheduleUpdate( UpdateTitleBar|UpdateButtons ); });
 
         createButtons();
         createShadow();
@@ -288,15 +417,55 @@ namespace Breeze
         setTitleBar(QRect(x, y, width, height));
     }
 
+    //________________________________________________________________
+    void Decoration::scheduleUpdate( int flags )
+    {
+        if( !m_pendingUpdates ) QTimer::singleShot( 0, this, &Decoration::flushUpdates );
+        m_pendingUpdates |= flags;
+    }
+
+    //________________________________________________________________
+    void Decoration::flushUpdates()
+    {
+        const int flags = m_pendingUpdates;
+        m_pendingUpdates = UpdateNone;
+
+        // title bar depends on borders, and buttons on both
+        if( flags & UpdateBorders ) recalculateBorders();
+        if( flags & (UpdateBorders|UpdateTitleBar|UpdateResize) ) updateTitleBar();
+        if( flags & UpdateButtons ) updateButtonsGeometry();
+        else if( flags & UpdateResize )
+        {
+            // only the right button group moves during a resize
+            updateRightButtonsPosition();
+            update();
+
+        } else if( flags & UpdateCaption ) update(titleBar());
+    }
+
+    //________________________________________________________________
+    void Decoration::updateWidth()
+    {
+        // button sizes and left group are unchanged while resizing
+        // a full relayout happens once resize settles
+        m_resizeTimer->start();
+        scheduleUpdate( UpdateResize );
+    }
+
     //________________________________________________________________
     void Decoration::updateAnimationState()
     {
-        if( m_internalSettings->animationsEnabled() )
+        if( m_config->animationsEnabled && PaintGovernor::self()->animationsAllowed() )
         {
 
             auto c = client().data();
-            m_animation->setDirection( c->isActive() ? QPropertyAnimation::Forward : QPropertyAnimation::Backward );
-            if( m_animation->state() != QPropertyAnimation::Running ) m_animation->start();
+            m_animation->setDirection( c->isActive() ? Animation::Forward : Animation::Backward );
+            if( !m_animation->isRunning() )
+            {
+                // both title bar states are rendered again on first animated paint
+                m_titleBarCache = TitleBarCache();
+                m_animation->start();
+            }
 
         } else {
 
@@ -317,9 +486,9 @@ namespace Breeze
     int Decoration::borderSize(bool bottom) const
     {
         const int baseSize = settings()->smallSpacing();
-        if( m_internalSettings && (m_internalSettings->mask() & BorderSize ) )
+        if( m_config && m_config->customBorderSize )
         {
-            switch (m_internalSettings->borderSize()) {
+            switch (m_config->borderSize) {
                 case InternalSettings::BorderNone: return 0;
                 case InternalSettings::BorderNoSides: return bottom ? qMax(4, baseSize) : 0;
                 default:
@@ -352,26 +521,60 @@ namespace Breeze
     }
 
     //________________________________________________________________
-    void Decoration::reconfigure()
+    void Decoration::setConfig( const DecorationConfigPtr& config )
     {
 
-        m_internalSettings = SettingsProvider::self()->internalSettings( this );
+        // only recompute what depends on changed settings
+        int changes = m_config ? config->changes( *m_config ) : int( DecorationConfig::ChangeAll );
+        m_config = config;
+
+        // caption layout depends on fonts
+        if( changes & DecorationConfig::ChangeTitleLayout )
+        {
+            resetCaptionLayout();
+            scheduleUpdate( UpdateTitleBar|UpdateButtons );
+        }
 
         // animation
-        m_animation->setDuration( m_internalSettings->animationsDuration() );
+        if( changes & DecorationConfig::ChangeAnimation )
+        { m_animation->setDuration( m_config->animationsDuration ); }
 
         // borders
-        recalculateBorders();
+        if( changes & DecorationConfig::ChangeBorders )
+        {
+            recalculateBorders();
+            scheduleUpdate( UpdateTitleBar|UpdateButtons );
+        }
 
         // shadow
-        createShadow();
+        if( changes & DecorationConfig::ChangeShadow ) createShadow();
 
-        // size grip
-        if( hasNoBorders() && m_internalSettings->drawSizeGrip() ) createSizeGrip();
-        else deleteSizeGrip();
+        // size grip depends on borders too, only report it when it is actually created or deleted
+        if( changes & (DecorationConfig::ChangeSizeGrip|DecorationConfig::ChangeBorders) )
+        {
+            if( updateSizeGrip() ) changes |= DecorationConfig::ChangeSizeGrip;
+            else changes &= ~DecorationConfig::ChangeSizeGrip;
+        }
+
+        // colors, also used by the cached title bars
+        if( changes & (DecorationConfig::ChangeColors|DecorationConfig::ChangeTitleLayout) ) updatePalette();
+
+        for( int bit = 0; bit < DecorationConfig::ChangeCount; ++bit )
+        { if( changes & (1<<bit) ) ++m_recomputedParts[bit]; }
+
+        // shown with QT_LOGGING_RULES="breeze10.decoration.debug=true"
+        qCDebug( BREEZE ) << "Decoration::setConfig - recomputed:" << changeNames( changes ).join( QStringLiteral( ", " ) );
 
     }
 
+    //________________________________________________________________
+    quint64 Decoration::recomputedParts( DecorationConfig::Change change ) const
+    {
+        for( int bit = 0; bit < DecorationConfig::ChangeCount; ++bit )
+        { if( change == (1<<bit) ) return m_recomputedParts[bit]; }
+        return 0;
+    }
+
     //________________________________________________________________
     void Decoration::recalculateBorders()
     {
@@ -387,8 +590,7 @@ namespace Breeze
         if( hideTitleBar() ) top = bottom;
         else {
             top += isMaximized() ? 0 : borderSize();
-            QFont f; f.fromString(m_internalSettings->titleBarFont());
-            QFontMetrics fm(f);
+            QFontMetrics fm(m_config->titleBarFont);
             top += qMax(fm.height(), buttonHeight() );
         }
 
@@ -409,6 +611,22 @@ namespace Breeze
         }
 
         setResizeOnlyBorders(QMargins(extSides, extTop, extSides, extBottom));
+
+        // opacity depends on which borders are painted
+        updateOpaque();
+    }
+
+    //________________________________________________________________
+    void Decoration::updateOpaque()
+    {
+        OpaqueGeometry geometry;
+        geometry.borderSize = borderSize();
+        geometry.borderTop = borderTop();
+        geometry.borderBottom = borderBottom();
+        geometry.buttonHeight = buttonHeight();
+        geometry.hideTitleBar = hideTitleBar();
+
+        setOpaque( Breeze::isOpaque( geometry, m_palette.titleBarAlpha ) );
     }
 
     //________________________________________________________________
@@ -421,7 +639,7 @@ namespace Breeze
 
     //________________________________________________________________
     void Decoration::updateButtonsGeometryDelayed()
-    { QTimer::singleShot( 0, this, &Decoration::updateButtonsGeometry ); }
+    { scheduleUpdate( UpdateButtons ); }
 
     //________________________________________________________________
     void Decoration::updateButtonsGeometry()
@@ -454,97 +672,177 @@ namespace Breeze
         {
 
             m_rightButtons->setSpacing(0);
-
-            // padding
-            m_rightButtons->setPos(QPointF(size().width() - m_rightButtons->geometry().width() - borderRight(), maximized ? 0 : borderSize()));
+            updateRightButtonsPosition();
 
         }
 
+        // cached title bars hold the previous button layout
+        invalidateTitleBarCache();
         update();
 
     }
 
+    //________________________________________________________________
+    void Decoration::updateRightButtonsPosition()
+    {
+        if( m_rightButtons->buttons().isEmpty() ) return;
+
+        // padding
+        const QPointF position( size().width() - m_rightButtons->geometry().width() - borderRight(), isMaximized() ? 0 : borderSize() );
+        if( m_rightButtons->pos() == position ) return;
+        m_rightButtons->setPos( position );
+        invalidateTitleBarCache();
+    }
+
     //________________________________________________________________
     void Decoration::paint(QPainter *painter, const QRect &repaintRegion)
     {
+        // paint duration, including buttons, is reported to the governor
+        PaintGovernor* governor( PaintGovernor::self() );
+        const bool measure( governor->isEnabled() );
+        QElapsedTimer timer;
+        if( measure ) timer.start();
+
         // TODO: optimize based on repaintRegion
-        auto c = client().data();
-        auto s = settings();
+        if( !settings()->isAlphaChannelSupported() ) paintOpaque(painter, repaintRegion);
+        else paintComposited(painter, repaintRegion);
 
-        const bool maximized = isMaximized();
+        if( measure )
+        { governor->addSample( timer.nsecsElapsed()/1000 ); }
+    }
 
+    //________________________________________________________________
+    void Decoration::paintComposited(QPainter *painter, const QRect &repaintRegion)
+    {
         // paint background
         if( borderSize() > 0 )
         {
             painter->fillRect(rect(), Qt::transparent);
-            painter->save();
-            painter->setRenderHint(QPainter::Antialiasing);
-            painter->setPen(Qt::NoPen);
 
-            QColor winCol = c->isActive() ? KColorUtils::mix( titleBarColor(), Qt::black, 0.3 ) : titleBarColor();
-            winCol.setAlpha(titleBarAlpha());
-            painter->setBrush(winCol);
+            QColor winCol = colors().frame;
+            winCol.setAlpha(m_palette.titleBarAlpha);
 
-            // clip away the titlebar part
-            if( !hideTitleBar() )
-            {
-                QRegion outerReg(rect());
-                QRegion innerReg(QRect(borderLeft(), maximized ? 0 : borderSize(), size().width() - borderLeft() - borderRight(), buttonHeight()));
-                painter->setClipRegion(outerReg.subtracted(innerReg));
-            }
+            // frame is made of integer rects, no clipping nor antialiasing needed
+            for( const QRect& rect : frameRects() )
+            { painter->fillRect( rect, winCol ); }
+        }
 
-            painter->drawRect( rect() );
+        if( !hideTitleBar() ) paintTitleBar(painter, repaintRegion);
 
-            painter->restore();
+    }
+
+    //________________________________________________________________
+    void Decoration::paintOpaque(QPainter *painter, const QRect &repaintRegion)
+    {
+        /*
+        without compositing, colors are fully opaque (see updatePalette)
+        and all shapes are integer aligned rects,
+        so there is no need for a transparent fill nor for antialiasing
+        */
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing, false);
+
+        if( borderSize() > 0 )
+        {
+            const QColor winCol = colors().frame;
+            for( const QRect& rect : frameRects() )
+            { painter->fillRect( rect, winCol ); }
         }
 
         if( !hideTitleBar() ) paintTitleBar(painter, repaintRegion);
 
-        if( hasBorders() && !s->isAlphaChannelSupported() )
+        if( hasBorders() )
         {
-            painter->save();
-            painter->setRenderHint(QPainter::Antialiasing, false);
             painter->setBrush( Qt::NoBrush );
-            painter->setPen( c->isActive() ?
-                c->color( ColorGroup::Active, ColorRole::TitleBar ):
-                c->color( ColorGroup::Inactive, ColorRole::Foreground ) );
-
+            painter->setPen( hasActiveColors() ? m_palette.active.outline : m_palette.inactive.outline );
             painter->drawRect( rect().adjusted( 0, 0, -1, -1 ) );
-            painter->restore();
         }
 
+        painter->restore();
+    }
+
+    //________________________________________________________________
+    const QVector<QRect>& Decoration::frameRects()
+    {
+        const bool maximized = isMaximized();
+        const bool titleBar = !hideTitleBar();
+        const QMargins borders( borderLeft(), borderTop(), borderRight(), borderBottom() );
+        const int buttonHeight = this->buttonHeight();
+
+        FrameCache& cache( m_frameCache );
+        if( cache.valid
+            && cache.size == size()
+            && cache.borders == borders
+            && cache.maximized == maximized
+            && cache.titleBar == titleBar
+            && cache.buttonHeight == buttonHeight )
+        { return cache.rects; }
+
+        cache.valid = true;
+        cache.size = size();
+        cache.borders = borders;
+        cache.maximized = maximized;
+        cache.titleBar = titleBar;
+        cache.buttonHeight = buttonHeight;
+        cache.rects.clear();
+
+        // clip away the titlebar part
+        QRegion region( rect() );
+        if( titleBar )
+        { region -= QRect( borderLeft(), maximized ? 0 : borderSize(), size().width() - borderLeft() - borderRight(), buttonHeight ); }
+
+        for( const QRect& rect : region )
+        { cache.rects.append( rect ); }
+
+        return cache.rects;
     }
 
     //________________________________________________________________
     void Decoration::paintTitleBar(QPainter *painter, const QRect &repaintRegion)
     {
-        const auto c = client().data();
         const bool maximized = isMaximized();
         const QRect titleRect(QPoint(borderLeft(), maximized ? 0 : borderSize()), QSize(size().width() - borderLeft() - borderRight(), buttonHeight()));
 
         if ( !titleRect.intersects(repaintRegion) ) return;
 
+        // activation animation crossfades between cached active and inactive title bars
+        if( hasAnimatedColors() )
+        {
+            paintTitleBarTransition(painter, titleRect);
+            return;
+        }
+
+        // the governor can restrict painting to cached title bars
+        if( PaintGovernor::self()->cachedOnly() )
+        {
+            const qreal devicePixelRatio( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+            painter->drawPixmap( titleRect.topLeft(), cachedTitleBar( hasActiveColors(), titleRect, devicePixelRatio ) );
+            return;
+        }
+
+        paintTitleBarContents(painter, titleRect, repaintRegion);
+    }
+
+    //________________________________________________________________
+    void Decoration::paintTitleBarContents(QPainter *painter, const QRect &titleRect, const QRect &repaintRegion)
+    {
         painter->save();
         painter->setPen(Qt::NoPen);
 
         QColor titleBarColor = this->titleBarColor();
-        titleBarColor.setAlpha(titleBarAlpha());
+        titleBarColor.setAlpha(m_palette.titleBarAlpha);
 
         painter->setBrush( titleBarColor );
 
-        auto s = settings();
         painter->drawRect(titleRect);
 
         painter->restore();
 
         // draw caption
-        QFont f; f.fromString(m_internalSettings->titleBarFont());
-        // KDE needs this FIXME: Why?
-        QFontDatabase fd; f.setStyleName(fd.styleString(f));
-        painter->setFont(f);
+        painter->setFont(m_config->captionFont);
         painter->setPen( fontColor() );
         const auto cR = captionRect();
-        const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
+        const QString caption = elidedCaption(painter->fontMetrics(), cR.first.width());
         painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
 
         // draw all buttons
@@ -552,11 +850,92 @@ namespace Breeze
         m_rightButtons->paint(painter, repaintRegion);
     }
 
+    //________________________________________________________________
+    const QPixmap& Decoration::cachedTitleBar( bool active, const QRect &titleRect, qreal devicePixelRatio )
+    {
+        if( m_titleBarCache.rect != titleRect || !qFuzzyCompare( m_titleBarCache.devicePixelRatio, devicePixelRatio ) )
+        {
+            m_titleBarCache = TitleBarCache();
+            m_titleBarCache.rect = titleRect;
+            m_titleBarCache.devicePixelRatio = devicePixelRatio;
+        }
+
+        // each state is rendered on first use
+        QPixmap& pixmap( m_titleBarCache.pixmaps[active ? 1 : 0] );
+        if( pixmap.isNull() )
+        {
+            pixmap = QPixmap( titleRect.size()*devicePixelRatio );
+            pixmap.setDevicePixelRatio( devicePixelRatio );
+            pixmap.fill( Qt::transparent );
+
+            QPainter pixmapPainter( &pixmap );
+            pixmapPainter.translate( -titleRect.topLeft() );
+            m_forcedColorGroup = active ? ForcedActive : ForcedInactive;
+            paintTitleBarContents( &pixmapPainter, titleRect, titleRect );
+            m_forcedColorGroup = ForcedNone;
+        }
+
+        return pixmap;
+    }
+
+    //________________________________________________________________
+    void Decoration::invalidateTitleBarCache()
+    { m_titleBarCache = TitleBarCache(); }
+
+    //________________________________________________________________
+    void Decoration::updateButtonState()
+    {
+        // button changes during the short crossfade only show once it ends, when the cache is freed
+        if( hasAnimatedColors() && !PaintGovernor::self()->cachedOnly() ) return;
+        invalidateTitleBarCache();
+    }
+
+    //________________________________________________________________
+    void Decoration::paintTitleBarTransition(QPainter *painter, const QRect &titleRect)
+    {
+        const qreal devicePixelRatio( painter->device() ? painter->device()->devicePixelRatioF() : 1.0 );
+        const QPixmap& inactive( cachedTitleBar( false, titleRect, devicePixelRatio ) );
+        const QPixmap& active( cachedTitleBar( true, titleRect, devicePixelRatio ) );
+
+        if( m_palette.titleBarAlpha == 255 )
+        {
+
+            // opaque title bar, blending over the inactive state is exact
+            painter->drawPixmap( titleRect.topLeft(), inactive );
+            painter->save();
+            painter->setOpacity( m_opacity );
+            painter->drawPixmap( titleRect.topLeft(), active );
+            painter->restore();
+
+        } else {
+
+            // translucent title bar, add weighted states so that alpha is interpolated too
+            QPixmap& blend( m_titleBarCache.pixmaps[2] );
+            if( blend.size() != inactive.size() )
+            {
+                blend = QPixmap( inactive.size() );
+                blend.setDevicePixelRatio( devicePixelRatio );
+            }
+
+            blend.fill( Qt::transparent );
+            QPainter blendPainter( &blend );
+            blendPainter.setCompositionMode( QPainter::CompositionMode_Plus );
+            blendPainter.setOpacity( 1.0 - m_opacity );
+            blendPainter.drawPixmap( 0, 0, inactive );
+            blendPainter.setOpacity( m_opacity );
+            blendPainter.drawPixmap( 0, 0, active );
+            blendPainter.end();
+
+            painter->drawPixmap( titleRect.topLeft(), blend );
+
+        }
+    }
+
     //________________________________________________________________
     int Decoration::buttonHeight() const
     {
         const int baseSize = 10; //settings()->gridUnit();
-        switch( m_internalSettings->buttonSize() )
+        switch( m_config->buttonSize )
         {
             case InternalSettings::ButtonTiny: return baseSize;
             case InternalSettings::ButtonSmall: return baseSize*2;
@@ -572,7 +951,7 @@ namespace Breeze
     int Decoration::iconSize() const
     {
         const int baseSize = 16;
-        switch( m_internalSettings->buttonSize() )
+        switch( m_config->buttonSize )
         {
             case InternalSettings::ButtonTiny: return baseSize/2;
             case InternalSettings::ButtonSmall: return baseSize;
@@ -590,14 +969,13 @@ namespace Breeze
         if( hideTitleBar() ) return qMakePair( QRect(), Qt::AlignCenter );
         else {
 
-            auto c = client().data();
             int leftOffset = m_leftButtons->buttons().isEmpty() ?
                 4.0*settings()->smallSpacing():
                 m_leftButtons->geometry().x() + m_leftButtons->geometry().width() + 4.0*settings()->smallSpacing();
 
             if (!m_leftButtons->buttons().isEmpty() 
                 && m_leftButtons->buttons().last().data()->type() == DecorationButtonType::Menu 
-                && m_internalSettings->titleAlignment() == InternalSettings::AlignLeft)
+                && m_config->titleAlignment == InternalSettings::AlignLeft)
             {
                 leftOffset -= 4.0 * settings()->smallSpacing();
             }
@@ -610,7 +988,7 @@ namespace Breeze
             const int yOffset = isMaximized() ? 0 : borderSize();
             const QRect maxRect( leftOffset, yOffset, size().width() - leftOffset - rightOffset, buttonHeight() );
 
-            switch( m_internalSettings->titleAlignment() )
+            switch( m_config->titleAlignment )
             {
                 case InternalSettings::AlignLeft:
                 return qMakePair( maxRect, Qt::AlignVCenter|Qt::AlignLeft );
@@ -627,9 +1005,7 @@ namespace Breeze
 
                     // full caption rect
                     const QRect fullRect = QRect( 0, yOffset, size().width(), buttonHeight() );
-                    QFont f; f.fromString(m_internalSettings->titleBarFont());
-                    QFontMetrics fm(f);
-                    QRect boundingRect( fm.boundingRect( c->caption()) );
+                    QRect boundingRect( captionBoundingRect() );
 
                     // text bounding rect
                     boundingRect.setTop( yOffset );
@@ -648,17 +1024,148 @@ namespace Breeze
 
     }
 
+    //________________________________________________________________
+    void Decoration::updateCaption()
+    {
+        const int rate = m_config->maxCaptionRepaintRate;
+        if( rate <= 0 )
+        {
+            flushCaption();
+            return;
+        }
+
+        // an update is already pending, it will pick up this caption
+        if( m_captionTimer->isActive() )
+        {
+            ++m_coalescedCaptionUpdates;
+            return;
+        }
+
+        const qint64 interval = 1000/rate;
+        const qint64 elapsed = m_lastCaptionUpdate.isValid() ? m_lastCaptionUpdate.elapsed() : interval;
+        if( elapsed >= interval ) flushCaption();
+        else m_captionTimer->start( interval - elapsed );
+    }
+
+    //________________________________________________________________
+    void Decoration::updateConfig()
+    {
+        auto provider = SettingsProvider::self();
+
+        // window class and type are only requested once a rule depends on them
+        {
+            const SnapshotPublisher::Reader snapshot( provider->snapshots() );
+            if( snapshot->hasClassNameRules || snapshot->hasDialogRules ) readWindowProperties();
+        }
+
+        m_resolutionKey = provider->resolutionKey( this );
+        setConfig( provider->resolve( m_resolutionKey ) );
+    }
+
+    //________________________________________________________________
+    void Decoration::readWindowProperties()
+    {
+        // class and type are set before a window is mapped and kept for its lifetime
+        if( m_windowPropertiesRead ) return;
+        m_windowPropertiesRead = true;
+
+        auto c = client().data();
+        if( c->windowId() )
+        {
+
+            const KWindowInfo info( c->windowId(), NET::WMWindowType, NET::WM2WindowClass );
+            m_windowClassName = QString::fromUtf8( info.windowClassName() ) + QStringLiteral(" ") + QString::fromUtf8( info.windowClassClass() );
+            m_isDialog = !( info.valid() && info.windowType( NET::NormalMask | NET::DialogMask ) != NET::Dialog );
+
+        } else {
+
+            // no window properties available, dialog rules apply as they do for invalid window info
+            m_windowClassName = QStringLiteral(" ");
+            m_isDialog = true;
+
+        }
+    }
+
+    //________________________________________________________________
+    void Decoration::updateTitleExceptions()
+    {
+        auto provider = SettingsProvider::self();
+        if( !provider->dynamicTitleExceptions() ) return;
+
+        // fast changing titles are only matched once they settle
+        if( !m_titleExceptionsTimer )
+        {
+            m_titleExceptionsTimer = new QTimer( this );
+            m_titleExceptionsTimer->setSingleShot( true );
+            connect( m_titleExceptionsTimer, &QTimer::timeout, this, &Decoration::flushTitleExceptions );
+        }
+
+        m_titleExceptionsTimer->start( provider->dynamicTitleExceptionsDelay() );
+    }
+
+    //________________________________________________________________
+    void Decoration::flushTitleExceptions()
+    {
+        // rules might have been disabled while waiting
+        auto provider = SettingsProvider::self();
+        if( !provider->dynamicTitleExceptions() ) return;
+
+        // window properties are known, only the title part of the key changes
+        ResolutionKey key( m_resolutionKey );
+        key.title = client().data()->caption();
+        if( key == m_resolutionKey ) return;
+
+        m_resolutionKey = key;
+        const DecorationConfigPtr config( provider->resolve( key ) );
+        if( config != m_config ) setConfig( config );
+    }
+
+    //________________________________________________________________
+    void Decoration::flushCaption()
+    {
+        m_lastCaptionUpdate.start();
+        resetCaptionLayout();
+        m_titleBarCache = TitleBarCache();
+        scheduleUpdate( UpdateCaption );
+    }
+
+    //________________________________________________________________
+    void Decoration::resetCaptionLayout()
+    {
+        // every visible character is at least one pixel wide, allow as many again for combining marks
+        const int width = client().data()->width();
+        m_captionLayout = CaptionLayout();
+        m_captionLayout.caption = sanitizeCaption( client().data()->caption(), qMax( s_minCaptionLength, 2*width ) );
+        m_captionLayout.width = width;
+    }
+
+    //________________________________________________________________
+    QRect Decoration::captionBoundingRect() const
+    {
+        if( !m_captionLayout.boundingRectValid )
+        {
+            m_captionLayout.boundingRect = QFontMetrics( m_config->titleBarFont ).boundingRect( m_captionLayout.caption );
+            m_captionLayout.boundingRectValid = true;
+        }
+
+        return m_captionLayout.boundingRect;
+    }
+
+    //________________________________________________________________
+    QString Decoration::elidedCaption( const QFontMetrics& metrics, int width ) const
+    { return m_captionLayout.elidedCaption( metrics, width ); }
+
     //________________________________________________________________
     void Decoration::createShadow()
     {
         if (!g_sShadow
-                ||g_shadowSizeEnum != m_internalSettings->shadowSize()
-                || g_shadowStrength != m_internalSettings->shadowStrength()
-                || g_shadowColor != m_internalSettings->shadowColor())
+                ||g_shadowSizeEnum != m_config->shadowSize
+                || g_shadowStrength != m_config->shadowStrength
+                || g_shadowColor != m_config->shadowColor)
         {
-            g_shadowSizeEnum = m_internalSettings->shadowSize();
-            g_shadowStrength = m_internalSettings->shadowStrength();
-            g_shadowColor = m_internalSettings->shadowColor();
+            g_shadowSizeEnum = m_config->shadowSize;
+            g_shadowStrength = m_config->shadowStrength;
+            g_shadowColor = m_config->shadowColor;
 
             const CompositeShadowParams params = lookupShadowParams(g_shadowSizeEnum);
             if (params.isNone()) {
@@ -727,6 +1234,15 @@ namespace Breeze
         setShadow(g_sShadow);
     }
 
+    //_________________________________________________________________
+    bool Decoration::updateSizeGrip()
+    {
+        const bool hadSizeGrip( m_sizeGrip );
+        if( hasNoBorders() && m_config->drawSizeGrip ) createSizeGrip();
+        else deleteSizeGrip();
+        return hadSizeGrip != bool( m_sizeGrip );
+    }
+
     //_________________________________________________________________
     void Decoration::createSizeGrip()
     {
@@ -23,15 +23,26 @@
  */
 
 #include "breeze.h"
+#include "breezeanimation.h"
+#include "breezecaption.h"
+#include "breezedecorationconfig.h"
+#include "breezeopaque.h"
+#include "breezesettingssnapshot.h"
 #include "breezesettings.h"
 
 #include <KDecoration2/Decoration>
 #include <KDecoration2/DecoratedClient>
 #include <KDecoration2/DecorationSettings>
 
+#include <QElapsedTimer>
+#include <QFont>
+#include <QFontMetrics>
 #include <QPalette>
-#include <QPropertyAnimation>
+#include <QPixmap>
+#include <QScopedPointer>
+#include <QTimer>
 #include <QVariant>
+#include <QVector>
 
 namespace KDecoration2
 {
@@ -42,13 +53,77 @@ namespace KDecoration2
 namespace Breeze
 {
     class SizeGrip;
+
+    //* colors derived from the client palette, for one color group
+    struct ColorSet
+    {
+        QColor titleBar;
+        QColor font;
+        QColor frame;
+        QColor outline;
+        QColor hover;
+        QColor pressed;
+    };
+
+    //* precomputed color transition, so that animation frames are a table lookup
+    class ColorRamp
+    {
+        public:
+
+        //* number of steps
+        enum { Size = 64 };
+
+        //* fill ramp from first to second color
+        void build( const QColor&, const QColor& );
+
+        //* color for given animation progress, in [0,1]
+        QColor at( qreal value ) const
+        { return QColor::fromRgba( m_colors[ qBound( 0, qRound( value*( Size - 1 ) ), Size - 1 ) ] ); }
+
+        private:
+
+        QRgb m_colors[Size] = {};
+    };
+
+    //* color ramps for animated color pairs
+    struct ColorRamps
+    {
+        //*@name inactive to active transitions
+        //@{
+        ColorRamp titleBar;
+        ColorRamp font;
+        ColorRamp frame;
+        ColorRamp hover;
+        ColorRamp pressed;
+        //@}
+
+        //*@name close button hover transitions, for inactive and active color groups
+        //@{
+        ColorRamp closeBackground[2];
+        ColorRamp closeForeground[2];
+        //@}
+    };
+
+    //* palette snapshot, computed once per palette or settings change
+    struct DecorationPalette
+    {
+        ColorSet active;
+        ColorSet inactive;
+        QColor closeHover;
+        QColor closePressed;
+
+        //* active frame color used when the title bar is hidden
+        QColor hiddenTitleBarFrame;
+        int titleBarAlpha = 255;
+
+        //* animation ramps
+        ColorRamps ramps;
+    };
+
     class Decoration : public KDecoration2::Decoration
     {
         Q_OBJECT
 
-        //* declare active state opacity
-        Q_PROPERTY( qreal opacity READ opacity WRITE setOpacity )
-
         public:
 
         //* constructor
@@ -60,9 +135,15 @@ namespace Breeze
         //* paint
         void paint(QPainter *painter, const QRect &repaintRegion) override;
 
-        //* internal settings
-        InternalSettingsPtr internalSettings() const
-        { return m_internalSettings; }
+        //* effective settings
+        const DecorationConfig& config() const
+        { return *m_config; }
+
+        //* apply effective settings
+        void setConfig( const DecorationConfigPtr& );
+
+        //* resolve effective settings for this window, and apply them
+        void updateConfig();
 
         //* caption height
         int captionHeight() const;
@@ -73,6 +154,27 @@ namespace Breeze
         //* icon size
         int iconSize() const;
 
+        //*@name window properties exceptions depend on
+        /** fetched once, when the first rule using them is configured. Empty until then */
+        //@{
+
+        //* window class name and class, separated by a space
+        const QString& windowClassName() const
+        { return m_windowClassName; }
+
+        //* true if the window is a dialog, or if its type is unknown
+        bool isDialog() const
+        { return m_isDialog; }
+
+        //@}
+
+        //* number of caption changes merged into another repaint, for diagnostics
+        quint64 coalescedCaptionUpdates() const
+        { return m_coalescedCaptionUpdates; }
+
+        //* number of settings changes that recomputed given part, for diagnostics
+        quint64 recomputedParts( DecorationConfig::Change ) const;
+
         //*@name active state change animation
         //@{
         void setOpacity( qreal );
@@ -87,8 +189,27 @@ namespace Breeze
         QColor titleBarColor() const;
         QColor outlineColor() const;
         QColor fontColor() const;
+
+        //* colors matching current active state, interpolated during animations
+        ColorSet colors() const;
+
+        //* true if active colors are used. This can differ from the client state while rendering cached title bars
+        bool hasActiveColors() const;
+
+        //* true if colors are interpolated by the activation animation
+        bool hasAnimatedColors() const;
+
+        //* palette snapshot
+        const DecorationPalette& palette() const
+        { return m_palette; }
         //@}
 
+        //* drop cached title bars, when their content changes outside of the decoration
+        void invalidateTitleBarCache();
+
+        //* drop cached title bars when a button state changes, unless crossfading
+        void updateButtonState();
+
         //*@name maximization modes
         //@{
         inline bool isMaximized() const;
@@ -107,21 +228,84 @@ namespace Breeze
         void init() override;
 
         private Q_SLOTS:
-        void reconfigure();
         void recalculateBorders();
         void updateButtonsGeometry();
         void updateButtonsGeometryDelayed();
         void updateTitleBar();
         void updateAnimationState();
         void updateSizeGripVisibility();
+        void updatePalette();
+        void updateOpaque();
+
+        //* activation animation step
+        void updateActivationOpacity( qreal );
+
+        //* resolve pending geometry updates
+        void flushUpdates();
+
+        //* client width changed
+        void updateWidth();
+
+        //* client caption changed, repaint is rate limited
+        void updateCaption();
+
+        //* repaint caption
+        void flushCaption();
+
+        //* client caption changed, title exceptions are re-evaluated once it settles
+        void updateTitleExceptions();
+
+        //* re-evaluate title exceptions
+        void flushTitleExceptions();
 
         private:
 
+        //* read window class and type, in a single request. Does nothing once read
+        void readWindowProperties();
+
+        //* pending geometry updates
+        enum UpdateFlag
+        {
+            UpdateNone = 0,
+            UpdateBorders = 1<<0,
+            UpdateTitleBar = 1<<1,
+            UpdateButtons = 1<<2,
+            UpdateCaption = 1<<3,
+            UpdateResize = 1<<4
+        };
+
+        //* mark given parts dirty, they are resolved together on next event loop iteration
+        void scheduleUpdate( int flags );
+
         //* return the rect in which caption will be drawn
         QPair<QRect,Qt::Alignment> captionRect() const;
 
+        //* reset caption layout to current client caption
+        void resetCaptionLayout();
+
+        //* bounding rect of the full caption, cached
+        QRect captionBoundingRect() const;
+
+        //* caption elided to given width, reusing previous elision when possible
+        QString elidedCaption( const QFontMetrics&, int width ) const;
+
+        //* move right button group to match decoration width
+        void updateRightButtonsPosition();
+
         void createButtons();
+
+        //* border frame, as a list of rects, cached per size, borders and maximized state
+        const QVector<QRect>& frameRects();
+
+        void paintComposited(QPainter *painter, const QRect &repaintRegion);
+        void paintOpaque(QPainter *painter, const QRect &repaintRegion);
         void paintTitleBar(QPainter *painter, const QRect &repaintRegion);
+        void paintTitleBarContents(QPainter *painter, const QRect &titleRect, const QRect &repaintRegion);
+        void paintTitleBarTransition(QPainter *painter, const QRect &titleRect);
+
+        //* title bar rendered for given state, cached per rect and device pixel ratio
+        const QPixmap& cachedTitleBar( bool active, const QRect &titleRect, qreal devicePixelRatio );
+
         void createShadow();
 
         //*@name border size
@@ -142,11 +326,25 @@ namespace Breeze
         //@{
         void createSizeGrip();
         void deleteSizeGrip();
+
+        //* create or delete size grip depending on borders and settings. Returns true if changed
+        bool updateSizeGrip();
         SizeGrip* sizeGrip() const
         { return m_sizeGrip; }
         //@}
 
-        InternalSettingsPtr m_internalSettings;
+        //* effective settings, shared with other decorations
+        DecorationConfigPtr m_config;
+
+        //*@name window properties
+        //@{
+        QString m_windowClassName;
+        bool m_isDialog = false;
+        bool m_windowPropertiesRead = false;
+        //@}
+
+        //* key the current settings were resolved with
+        ResolutionKey m_resolutionKey;
         KDecoration2::DecorationButtonGroup *m_leftButtons = nullptr;
         KDecoration2::DecorationButtonGroup *m_rightButtons = nullptr;
 
@@ -154,67 +352,121 @@ namespace Breeze
         SizeGrip *m_sizeGrip = nullptr;
 
         //* active state change animation
-        QPropertyAnimation *m_animation;
+        QScopedPointer<Animation> m_animation;
 
         //* active state change opacity
         qreal m_opacity = 0;
 
+        //* palette snapshot
+        DecorationPalette m_palette;
+
+        //* pending geometry updates
+        int m_pendingUpdates = UpdateNone;
+
+        //* border frame geometry
+        struct FrameCache
+        {
+            bool valid = false;
+            QSize size;
+            QMargins borders;
+            bool maximized = false;
+            bool titleBar = false;
+            int buttonHeight = 0;
+            QVector<QRect> rects;
+        };
+
+        FrameCache m_frameCache;
+
+        //* color group forced while rendering cached title bars
+        enum ForcedColorGroup
+        {
+            ForcedNone,
+            ForcedInactive,
+            ForcedActive
+        };
+
+        ForcedColorGroup m_forcedColorGroup = ForcedNone;
+
+        //* inactive and active title bars, plus blending buffer, used for the activation crossfade
+        //* and by the paint governor
+        struct TitleBarCache
+        {
+            QRect rect;
+            qreal devicePixelRatio = 0;
+            QPixmap pixmaps[3];
+        };
+
+        TitleBarCache m_titleBarCache;
+
+        //* caption layout, reused across width changes
+        mutable CaptionLayout m_captionLayout;
+
+        //* trailing caption update timer
+        QTimer *m_captionTimer = nullptr;
+
+        //* last caption update
+        QElapsedTimer m_lastCaptionUpdate;
+
+        //* number of caption changes merged into another repaint
+        quint64 m_coalescedCaptionUpdates = 0;
+
+        //* number of settings changes that recomputed each part, one entry per change bit
+        quint64 m_recomputedParts[DecorationConfig::ChangeCount] = {};
+
+        //* resize settle timer
+        QTimer *m_resizeTimer = nullptr;
+
+        //* title exceptions settle timer, only created when dynamic title exceptions are used
+        QTimer *m_titleExceptionsTimer = nullptr;
     };
 
     bool Decoration::hasBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() > InternalSettings::BorderNoSides;
+        if( m_config && m_config->customBorderSize ) return m_config->borderSize > InternalSettings::BorderNoSides;
         else return settings()->borderSize() > KDecoration2::BorderSize::NoSides;
     }
 
     bool Decoration::hasNoBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() == InternalSettings::BorderNone;
+        if( m_config && m_config->customBorderSize ) return m_config->borderSize == InternalSettings::BorderNone;
         else return settings()->borderSize() == KDecoration2::BorderSize::None;
     }
 
     bool Decoration::hasNoSideBorders() const
     {
-        if( m_internalSettings && m_internalSettings->mask() & BorderSize ) return m_internalSettings->borderSize() == InternalSettings::BorderNoSides;
+        if( m_config && m_config->customBorderSize ) return m_config->borderSize == InternalSettings::BorderNoSides;
         else return settings()->borderSize() == KDecoration2::BorderSize::NoSides;
     }
 
     bool Decoration::isMaximized() const
-    { return client().data()->isMaximized() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().data()->isMaximized() && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isMaximizedHorizontally() const
-    { return client().data()->isMaximizedHorizontally() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().data()->isMaximizedHorizontally() && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isMaximizedVertically() const
-    { return client().data()->isMaximizedVertically() && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return client().data()->isMaximizedVertically() && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isLeftEdge() const
-    { return (client().data()->isMaximizedHorizontally() || client().data()->adjacentScreenEdges().testFlag( Qt::LeftEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return (client().data()->isMaximizedHorizontally() || client().data()->adjacentScreenEdges().testFlag( Qt::LeftEdge ) ) && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isRightEdge() const
-    { return (client().data()->isMaximizedHorizontally() || client().data()->adjacentScreenEdges().testFlag( Qt::RightEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return (client().data()->isMaximizedHorizontally() || client().data()->adjacentScreenEdges().testFlag( Qt::RightEdge ) ) && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isTopEdge() const
-    { return (client().data()->isMaximizedVertically() || client().data()->adjacentScreenEdges().testFlag( Qt::TopEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return (client().data()->isMaximizedVertically() || client().data()->adjacentScreenEdges().testFlag( Qt::TopEdge ) ) && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::isBottomEdge() const
-    { return (client().data()->isMaximizedVertically() || client().data()->adjacentScreenEdges().testFlag( Qt::BottomEdge ) ) && !m_internalSettings->drawBorderOnMaximizedWindows(); }
+    { return (client().data()->isMaximizedVertically() || client().data()->adjacentScreenEdges().testFlag( Qt::BottomEdge ) ) && !m_config->drawBorderOnMaximizedWindows; }
 
     bool Decoration::hideTitleBar() const
-    { return m_internalSettings->hideTitleBar() && !client().data()->isShaded(); }
+    { return m_config->hideTitleBar && !client().data()->isShaded(); }
 
     bool Decoration::opaqueTitleBar() const
-    { return m_internalSettings->opaqueTitleBar(); }
+    { return m_config->opaqueTitleBar; }
 
     int Decoration::titleBarAlpha() const
-    {
-        if (m_internalSettings->opaqueTitleBar())
-            return 255;
-        int a = m_internalSettings->opacityOverride() > -1 ? m_internalSettings->opacityOverride()
-                                                           : m_internalSettings->backgroundOpacity();
-        a =  qBound(0, a, 100);
-        return qRound(static_cast<qreal>(a) * static_cast<qreal>(2.55));
-    }
+    { return Breeze::titleBarAlpha( m_config->opaqueTitleBar, m_config->backgroundOpacity, m_config->opacityOverride ); }
 
 }
 
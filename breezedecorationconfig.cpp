@@ -0,0 +1,119 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezedecorationconfig.h"
+
+#include "breeze.h"
+
+#include <QFontDatabase>
+
+namespace Breeze
+{
+
+    //__________________________________________________________________
+    DecorationConfig::DecorationConfig( const InternalSettings& settings ):
+        shadowSize( settings.shadowSize() ),
+        shadowStrength( settings.shadowStrength() ),
+        shadowColor( settings.shadowColor() ),
+        customBorderSize( settings.mask() & BorderSize ),
+        borderSize( settings.borderSize() ),
+        drawBorderOnMaximizedWindows( settings.drawBorderOnMaximizedWindows() ),
+        drawSizeGrip( settings.drawSizeGrip() ),
+        titleAlignment( settings.titleAlignment() ),
+        buttonSize( settings.buttonSize() ),
+        maxCaptionRepaintRate( settings.maxCaptionRepaintRate() ),
+        hideTitleBar( settings.hideTitleBar() ),
+        opaqueTitleBar( settings.opaqueTitleBar() ),
+        backgroundOpacity( settings.backgroundOpacity() ),
+        opacityOverride( settings.opacityOverride() ),
+        animationsEnabled( settings.animationsEnabled() ),
+        animationsDuration( settings.animationsDuration() )
+    {
+        // fonts are parsed once, exceptions share them with the defaults
+        titleBarFont.fromString( settings.titleBarFont() );
+
+        // KDE needs this FIXME: Why?
+        captionFont = titleBarFont;
+        QFontDatabase fd; captionFont.setStyleName( fd.styleString( captionFont ) );
+    }
+
+    //__________________________________________________________________
+    int DecorationConfig::changes( const DecorationConfig& other ) const
+    {
+        int changes = ChangeNone;
+
+        // title bar height depends on button size and font
+        if( customBorderSize != other.customBorderSize
+            || borderSize != other.borderSize
+            || drawBorderOnMaximizedWindows != other.drawBorderOnMaximizedWindows
+            || hideTitleBar != other.hideTitleBar
+            || buttonSize != other.buttonSize
+            || titleBarFont != other.titleBarFont )
+        { changes |= ChangeBorders; }
+
+        if( titleAlignment != other.titleAlignment
+            || buttonSize != other.buttonSize
+            || titleBarFont != other.titleBarFont
+            || captionFont != other.captionFont
+            || hideTitleBar != other.hideTitleBar )
+        { changes |= ChangeTitleLayout; }
+
+        if( opaqueTitleBar != other.opaqueTitleBar
+            || backgroundOpacity != other.backgroundOpacity
+            || opacityOverride != other.opacityOverride )
+        { changes |= ChangeColors; }
+
+        if( shadowSize != other.shadowSize
+            || shadowStrength != other.shadowStrength
+            || shadowColor != other.shadowColor )
+        { changes |= ChangeShadow; }
+
+        if( animationsEnabled != other.animationsEnabled
+            || animationsDuration != other.animationsDuration )
+        { changes |= ChangeAnimation; }
+
+        if( drawSizeGrip != other.drawSizeGrip ) changes |= ChangeSizeGrip;
+
+        // caption repaint rate is read on every caption change, nothing to recompute
+        return changes;
+    }
+
+    //__________________________________________________________________
+    bool DecorationConfig::operator == ( const DecorationConfig& other ) const
+    {
+        return shadowSize == other.shadowSize
+            && shadowStrength == other.shadowStrength
+            && shadowColor == other.shadowColor
+            && customBorderSize == other.customBorderSize
+            && borderSize == other.borderSize
+            && drawBorderOnMaximizedWindows == other.drawBorderOnMaximizedWindows
+            && drawSizeGrip == other.drawSizeGrip
+            && titleAlignment == other.titleAlignment
+            && buttonSize == other.buttonSize
+            && titleBarFont == other.titleBarFont
+            && captionFont == other.captionFont
+            && maxCaptionRepaintRate == other.maxCaptionRepaintRate
+            && hideTitleBar == other.hideTitleBar
+            && opaqueTitleBar == other.opaqueTitleBar
+            && backgroundOpacity == other.backgroundOpacity
+            && opacityOverride == other.opacityOverride
+            && animationsEnabled == other.animationsEnabled
+            && animationsDuration == other.animationsDuration;
+    }
+
+}
@@ -0,0 +1,114 @@
+#ifndef breezedecorationconfig_h
+#define breezedecorationconfig_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesettings.h"
+
+#include <QColor>
+#include <QFont>
+#include <QSharedPointer>
+#include <QString>
+
+namespace Breeze
+{
+
+    //* effective decoration settings, flattened from InternalSettings
+    /**
+    built once per reconfigure for the defaults and for each matching exception,
+    then shared, read-only, by all decorations it applies to
+    */
+    struct DecorationConfig
+    {
+
+        //* default constructor
+        DecorationConfig() = default;
+
+        //* constructor from settings
+        explicit DecorationConfig( const InternalSettings& );
+
+        //*@name shadow
+        //@{
+        int shadowSize = InternalSettings::ShadowLarge;
+        int shadowStrength = 255;
+        QColor shadowColor;
+        //@}
+
+        //*@name borders
+        //@{
+
+        //* true if border size overrides the one set by kwin
+        bool customBorderSize = false;
+        int borderSize = InternalSettings::BorderNoSides;
+        bool drawBorderOnMaximizedWindows = false;
+        bool drawSizeGrip = false;
+        //@}
+
+        //*@name title bar
+        //@{
+        int titleAlignment = InternalSettings::AlignCenterFullWidth;
+        int buttonSize = InternalSettings::ButtonDefault;
+        QFont titleBarFont;
+        QFont captionFont;
+        int maxCaptionRepaintRate = 30;
+        bool hideTitleBar = false;
+        bool opaqueTitleBar = false;
+        int backgroundOpacity = 100;
+        int opacityOverride = -1;
+        //@}
+
+        //*@name animations
+        //@{
+        bool animationsEnabled = true;
+        int animationsDuration = 150;
+        //@}
+
+        //* decoration parts affected by a config change
+        enum Change
+        {
+            ChangeNone = 0,
+            ChangeBorders = 1<<0,
+            ChangeTitleLayout = 1<<1,
+            ChangeColors = 1<<2,
+            ChangeShadow = 1<<3,
+            ChangeAnimation = 1<<4,
+            ChangeSizeGrip = 1<<5,
+            ChangeAll = ChangeBorders|ChangeTitleLayout|ChangeColors|ChangeShadow|ChangeAnimation|ChangeSizeGrip
+        };
+
+        //* number of single part changes
+        enum { ChangeCount = 6 };
+
+        //* parts affected when switching from given config to this one
+        int changes( const DecorationConfig& ) const;
+
+        //* equality
+        bool operator == ( const DecorationConfig& ) const;
+
+        bool operator != ( const DecorationConfig& other ) const
+        { return !( *this == other ); }
+
+    };
+
+    //* shared, immutable configuration
+    using DecorationConfigPtr = QSharedPointer<const DecorationConfig>;
+
+}
+
+#endif
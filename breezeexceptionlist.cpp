@@ -91,6 +91,53 @@ namespace Breeze
 
     }
 
+    //______________________________________________________________
+    ExceptionRuleList ExceptionList::readRules( KSharedConfig::Ptr config )
+    {
+
+        ExceptionRuleList rules;
+
+        // single skeleton, only used to parse entries, enums in particular
+        InternalSettings parser;
+        QVector<KConfigSkeletonItem*> items;
+        foreach( auto key, exceptionKeys() )
+        { if( KConfigSkeletonItem* item = parser.findItem( key ) ) items.append( item ); }
+
+        QString groupName;
+        for( int index = 0; config->hasGroup( groupName = exceptionGroupName( index ) ); ++index )
+        {
+
+            for( KConfigSkeletonItem* item : items )
+            {
+                item->setGroup( groupName );
+                item->readConfig( config.data() );
+            }
+
+            ExceptionRule rule;
+            rule.pattern = parser.exceptionPattern();
+            rule.type = parser.exceptionType();
+            rule.mask = parser.mask();
+            rule.enabled = parser.enabled();
+            rule.isDialog = parser.isDialog();
+            rule.hideTitleBar = parser.hideTitleBar();
+            rule.opaqueTitleBar = parser.opaqueTitleBar();
+            rule.opacityOverride = parser.opacityOverride();
+            rule.borderSize = parser.borderSize();
+            rules.append( rule );
+
+        }
+
+        return rules;
+
+    }
+
+    //_______________________________________________________________________
+    const QStringList& ExceptionList::exceptionKeys()
+    {
+        static const QStringList keys = { "Enabled", "ExceptionPattern", "ExceptionType", "HideTitleBar", "IsDialog", "OpaqueTitleBar", "OpacityOverride", "Mask", "BorderSize"};
+        return keys;
+    }
+
     //_______________________________________________________________________
     QString ExceptionList::exceptionGroupName( int index )
     { return QString( "Windeco Exception %1" ).arg( index ); }
@@ -99,11 +146,8 @@ namespace Breeze
     void ExceptionList::writeConfig( KCoreConfigSkeleton* skeleton, KConfig* config, const QString& groupName )
     {
 
-        // list of items to be written
-        QStringList keys = { "Enabled", "ExceptionPattern", "ExceptionType", "HideTitleBar", "IsDialog", "OpaqueTitleBar", "OpacityOverride", "Mask", "BorderSize"};
-
         // write all items
-        foreach( auto key, keys )
+        foreach( auto key, exceptionKeys() )
         {
             KConfigSkeletonItem* item( skeleton->findItem( key ) );
             if( !item ) continue;
@@ -32,9 +32,27 @@
 
 #include <KSharedConfig>
 
+#include <QVector>
+
 namespace Breeze
 {
 
+    //! compact exception, holding only the fields an exception can override
+    struct ExceptionRule
+    {
+        QString pattern;
+        int type = InternalSettings::ExceptionWindowClassName;
+        int mask = 0;
+        bool enabled = true;
+        bool isDialog = false;
+        bool hideTitleBar = false;
+        bool opaqueTitleBar = false;
+        int opacityOverride = -1;
+        int borderSize = InternalSettings::BorderNoSides;
+    };
+
+    using ExceptionRuleList = QVector<ExceptionRule>;
+
     //! breeze exceptions list
     class ExceptionList
     {
@@ -56,6 +74,9 @@ namespace Breeze
         //! write to kconfig
         void writeConfig( KSharedConfig::Ptr );
 
+        //! read compact rules from KConfig, without building settings for each exception
+        static ExceptionRuleList readRules( KSharedConfig::Ptr );
+
         protected:
 
         //! generate exception group name for given exception index
@@ -67,6 +88,9 @@ namespace Breeze
         //! write configuration
         static void writeConfig( KCoreConfigSkeleton*, KConfig*, const QString& );
 
+        //! keys stored for each exception
+        static const QStringList& exceptionKeys();
+
         private:
 
         //! exceptions
@@ -0,0 +1,132 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeiconatlas.h"
+
+#include <QPainter>
+
+namespace Breeze
+{
+
+    IconAtlas *IconAtlas::s_self = nullptr;
+
+    //* maximum atlas size, in bytes
+    static const int g_maxAtlasCost = 8*1024*1024;
+
+    //__________________________________________________________________
+    IconAtlas::IconAtlas():
+        m_glyphs( g_maxAtlasCost ),
+        m_applicationIcons( g_maxAtlasCost )
+    {}
+
+    //__________________________________________________________________
+    IconAtlas::~IconAtlas()
+    { s_self = nullptr; }
+
+    //__________________________________________________________________
+    IconAtlas *IconAtlas::self()
+    {
+        if( !s_self )
+        { s_self = new IconAtlas(); }
+
+        return s_self;
+    }
+
+    //__________________________________________________________________
+    QPixmap IconAtlas::pixmap( const Key& key )
+    {
+        if( QPixmap* pixmap = m_glyphs.object( key ) )
+        {
+            ++m_hits;
+            return *pixmap;
+        }
+
+        ++m_misses;
+        return QPixmap();
+    }
+
+    //__________________________________________________________________
+    void IconAtlas::insert( const Key& key, const QPixmap& pixmap )
+    {
+        const int cost = pixmap.width()*pixmap.height()*pixmap.depth()/8;
+        m_glyphs.insert( key, new QPixmap( pixmap ), cost );
+    }
+
+    //__________________________________________________________________
+    IconAtlas::ApplicationIconKey IconAtlas::applicationIconKey( const QIcon& icon, int size, qreal devicePixelRatio )
+    {
+        ApplicationIconKey key;
+        key.name = icon.name();
+        key.cacheKey = key.name.isEmpty() ? icon.cacheKey() : 0;
+        key.size = size;
+        key.devicePixelRatio = devicePixelRatio;
+        return key;
+    }
+
+    //__________________________________________________________________
+    QPixmap IconAtlas::applicationIcon( const QIcon& icon, const ApplicationIconKey& key )
+    {
+        if( QPixmap* pixmap = m_applicationIcons.object( key ) )
+        {
+            ++m_applicationIconHits;
+            return *pixmap;
+        }
+
+        ++m_applicationIconMisses;
+
+        // render icon the same way QIcon::paint would
+        QPixmap pixmap( QSize( key.size, key.size )*key.devicePixelRatio );
+        pixmap.setDevicePixelRatio( key.devicePixelRatio );
+        pixmap.fill( Qt::transparent );
+
+        QPainter painter( &pixmap );
+        icon.paint( &painter, QRect( 0, 0, key.size, key.size ) );
+        painter.end();
+
+        const int cost = pixmap.width()*pixmap.height()*pixmap.depth()/8;
+        m_applicationIcons.insert( key, new QPixmap( pixmap ), cost );
+        return pixmap;
+    }
+
+    //__________________________________________________________________
+    void IconAtlas::removeApplicationIcon( const ApplicationIconKey& key )
+    { m_applicationIcons.remove( key ); }
+
+    //__________________________________________________________________
+    IconAtlas::Statistics IconAtlas::statistics() const
+    {
+        Statistics statistics;
+        statistics.count = m_glyphs.count();
+        statistics.bytes = m_glyphs.totalCost();
+        statistics.applicationIconCount = m_applicationIcons.count();
+        statistics.applicationIconBytes = m_applicationIcons.totalCost();
+        statistics.hits = m_hits;
+        statistics.misses = m_misses;
+        statistics.applicationIconHits = m_applicationIconHits;
+        statistics.applicationIconMisses = m_applicationIconMisses;
+        return statistics;
+    }
+
+    //__________________________________________________________________
+    void IconAtlas::clear()
+    {
+        m_glyphs.clear();
+        m_applicationIcons.clear();
+    }
+
+}
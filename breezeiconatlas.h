@@ -0,0 +1,194 @@
+#ifndef breezeiconatlas_h
+#define breezeiconatlas_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <KDecoration2/DecorationButton>
+
+#include <QCache>
+#include <QColor>
+#include <QIcon>
+#include <QObject>
+#include <QPixmap>
+#include <QSize>
+
+namespace Breeze
+{
+
+    //* shared cache of pre-rendered button glyphs and application icons
+    class IconAtlas: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* destructor
+        ~IconAtlas();
+
+        //* singleton
+        static IconAtlas *self();
+
+        //* glyph key
+        struct Key
+        {
+            KDecoration2::DecorationButtonType type;
+            bool checked;
+            bool antialiased;
+            QRgb foreground;
+            QRgb background;
+            QRgb fallback;
+            QSize size;
+            qreal devicePixelRatio;
+
+            bool operator == (const Key& other ) const
+            {
+                return type == other.type
+                    && checked == other.checked
+                    && antialiased == other.antialiased
+                    && foreground == other.foreground
+                    && background == other.background
+                    && fallback == other.fallback
+                    && size == other.size
+                    && qFuzzyCompare( devicePixelRatio, other.devicePixelRatio );
+            }
+
+        };
+
+        //* application icon key
+        /**
+        themed icons are identified by name, so that all windows of a given application
+        share the same pixmap. Other icons are identified by their cache key
+        */
+        struct ApplicationIconKey
+        {
+            QString name;
+            qint64 cacheKey = 0;
+            int size = 0;
+            qreal devicePixelRatio = 1.0;
+
+            bool operator == (const ApplicationIconKey& other ) const
+            {
+                return cacheKey == other.cacheKey
+                    && size == other.size
+                    && name == other.name
+                    && qFuzzyCompare( devicePixelRatio, other.devicePixelRatio );
+            }
+
+        };
+
+        //* atlas statistics
+        struct Statistics
+        {
+            //*@name glyphs
+            //@{
+            int count = 0;
+            int bytes = 0;
+            quint64 hits = 0;
+            quint64 misses = 0;
+            //@}
+
+            //*@name application icons
+            //@{
+            int applicationIconCount = 0;
+            int applicationIconBytes = 0;
+            quint64 applicationIconHits = 0;
+            quint64 applicationIconMisses = 0;
+            //@}
+
+            qreal hitRate() const
+            { return (hits + misses) > 0 ? qreal( hits )/( hits + misses ) : 0; }
+
+            qreal applicationIconHitRate() const
+            {
+                const quint64 total = applicationIconHits + applicationIconMisses;
+                return total > 0 ? qreal( applicationIconHits )/total : 0;
+            }
+        };
+
+        //* cached glyph for given key, null pixmap if not found
+        QPixmap pixmap( const Key& );
+
+        //* store glyph for given key
+        void insert( const Key&, const QPixmap& );
+
+        //* key for given application icon
+        static ApplicationIconKey applicationIconKey( const QIcon&, int size, qreal devicePixelRatio );
+
+        //* cached application icon, rendered on first use
+        QPixmap applicationIcon( const QIcon&, const ApplicationIconKey& );
+
+        //* drop cached application icon
+        void removeApplicationIcon( const ApplicationIconKey& );
+
+        //* statistics
+        Statistics statistics() const;
+
+        public Q_SLOTS:
+
+        //* drop all cached glyphs and application icons, for instance when the icon theme changes
+        void clear();
+
+        private:
+
+        //* constructor
+        IconAtlas();
+
+        //* glyphs, cost is in bytes
+        QCache<Key, QPixmap> m_glyphs;
+
+        //* application icons, cost is in bytes
+        QCache<ApplicationIconKey, QPixmap> m_applicationIcons;
+
+        //*@name statistics
+        //@{
+        quint64 m_hits = 0;
+        quint64 m_misses = 0;
+        quint64 m_applicationIconHits = 0;
+        quint64 m_applicationIconMisses = 0;
+        //@}
+
+        //* singleton
+        static IconAtlas *s_self;
+
+    };
+
+    //* hash
+    inline uint qHash( const IconAtlas::Key& key, uint seed = 0 )
+    {
+        return ::qHash( static_cast<int>( key.type ) << 2 | int( key.checked ) << 1 | int( key.antialiased ), seed )
+            ^ ::qHash( key.foreground, seed ) * 31
+            ^ ::qHash( key.background, seed ) * 37
+            ^ ::qHash( key.fallback, seed ) * 41
+            ^ ::qHash( key.size.width() << 16 | key.size.height(), seed )
+            ^ ::qHash( qRound( key.devicePixelRatio*100 ), seed );
+    }
+
+    //* hash
+    inline uint qHash( const IconAtlas::ApplicationIconKey& key, uint seed = 0 )
+    {
+        return ::qHash( key.name, seed )
+            ^ ::qHash( key.cacheKey, seed ) * 31
+            ^ ::qHash( key.size, seed ) * 37
+            ^ ::qHash( qRound( key.devicePixelRatio*100 ), seed );
+    }
+
+}
+
+#endif
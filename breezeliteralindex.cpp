@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeliteralindex.h"
+
+#include <algorithm>
+
+namespace Breeze
+{
+
+    //__________________________________________________________________
+    bool LiteralIndex::isLiteral( const QString& pattern )
+    {
+        static const QString metaCharacters( QStringLiteral( "\\^$.|?*+()[]{}" ) );
+        for( const QChar& c : pattern )
+        { if( metaCharacters.contains( c ) ) return false; }
+
+        return true;
+    }
+
+    //__________________________________________________________________
+    void LiteralIndex::clear()
+    {
+        m_nodes = QVector<Node>( 1 );
+        m_transitions.clear();
+    }
+
+    //__________________________________________________________________
+    void LiteralIndex::insert( const QString& literal, int value )
+    {
+        int node = 0;
+        for( const QChar& c : literal )
+        {
+            int next = transition( node, c );
+            if( next < 0 )
+            {
+                next = m_nodes.size();
+                Node child;
+                child.character = c;
+                m_nodes.append( child );
+                m_nodes[node].children.append( next );
+                m_transitions.insert( key( node, c ), next );
+            }
+
+            node = next;
+        }
+
+        m_nodes[node].values.append( value );
+    }
+
+    //__________________________________________________________________
+    void LiteralIndex::build()
+    {
+        // breadth first, so that failure targets are always complete when reached
+        QVector<int> queue( m_nodes[0].children );
+        for( int child : queue ) m_nodes[child].fail = 0;
+
+        for( int i = 0; i < queue.size(); ++i )
+        {
+            const int node = queue[i];
+            for( int child : m_nodes[node].children )
+            {
+                const QChar c( m_nodes[child].character );
+
+                int fail = m_nodes[node].fail;
+                int next;
+                while( ( next = transition( fail, c ) ) < 0 && fail != 0 )
+                { fail = m_nodes[fail].fail; }
+
+                m_nodes[child].fail = next < 0 ? 0 : next;
+
+                // literals ending at the failure target also end here
+                m_nodes[child].values += m_nodes[m_nodes[child].fail].values;
+
+                queue.append( child );
+            }
+        }
+    }
+
+    //__________________________________________________________________
+    QVector<int> LiteralIndex::match( const QString& text ) const
+    {
+        QVector<int> values;
+        if( isEmpty() ) return values;
+
+        int node = 0;
+        for( const QChar& c : text )
+        {
+            int next;
+            while( ( next = transition( node, c ) ) < 0 && node != 0 )
+            { node = m_nodes[node].fail; }
+
+            node = next < 0 ? 0 : next;
+            values += m_nodes[node].values;
+        }
+
+        std::sort( values.begin(), values.end() );
+        values.erase( std::unique( values.begin(), values.end() ), values.end() );
+        return values;
+    }
+
+}
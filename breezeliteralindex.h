@@ -0,0 +1,88 @@
+#ifndef breezeliteralindex_h
+#define breezeliteralindex_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace Breeze
+{
+
+    //* Aho-Corasick automaton finding all literals contained in a string in a single pass
+    class LiteralIndex
+    {
+
+        public:
+
+        //* true if pattern has no regular expression metacharacters, so that matching it is a substring search
+        static bool isLiteral( const QString& );
+
+        //* true if empty
+        bool isEmpty() const
+        { return m_nodes.size() <= 1; }
+
+        //* remove all literals
+        void clear();
+
+        //* add literal, with associated value. build() must be called before matching
+        void insert( const QString&, int value );
+
+        //* compute failure links
+        void build();
+
+        //* values of all literals contained in given text, sorted and unique
+        QVector<int> match( const QString& ) const;
+
+        private:
+
+        //* transition from given node, -1 if none
+        int transition( int node, QChar c ) const
+        { return m_transitions.value( key( node, c ), -1 ); }
+
+        //* transition key
+        static quint64 key( int node, QChar c )
+        { return quint64( node ) << 16 | c.unicode(); }
+
+        struct Node
+        {
+            //* character leading to this node
+            QChar character;
+
+            //* longest proper suffix also present in the trie
+            int fail = 0;
+
+            QVector<int> children;
+
+            //* values of literals ending here, including through failure links once built
+            QVector<int> values;
+        };
+
+        //* nodes, the root being first
+        QVector<Node> m_nodes = QVector<Node>( 1 );
+
+        //* goto function
+        QHash<quint64, int> m_transitions;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef breezeopaque_h
+#define breezeopaque_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtGlobal>
+
+namespace Breeze
+{
+
+    //* decoration geometry that decides which pixels get painted
+    struct OpaqueGeometry
+    {
+        //* side border size, as returned by Decoration::borderSize()
+        int borderSize = 0;
+
+        //* top and bottom borders, as set by Decoration::recalculateBorders()
+        int borderTop = 0;
+        int borderBottom = 0;
+
+        //* title bar height actually painted
+        int buttonHeight = 0;
+
+        //* true if the title bar is hidden
+        bool hideTitleBar = false;
+    };
+
+    //* title bar alpha, in [0,255], for given opacity settings. A negative override is ignored
+    inline int titleBarAlpha( bool opaqueTitleBar, int backgroundOpacity, int opacityOverride )
+    {
+        if( opaqueTitleBar ) return 255;
+        const int opacity = qBound( 0, opacityOverride > -1 ? opacityOverride : backgroundOpacity, 100 );
+        return qRound( opacity*2.55 );
+    }
+
+    //* true if every pixel of the decoration is painted with given alpha, and alpha is 255
+    inline bool isOpaque( const OpaqueGeometry& geometry, int titleBarAlpha )
+    {
+        if( titleBarAlpha != 255 ) return false;
+
+        // the frame, and with it side and bottom borders, is only painted when borderSize() is positive
+        if( geometry.borderSize > 0 ) return true;
+
+        // otherwise only the title bar is, which covers buttonHeight of the top border
+        return geometry.borderBottom == 0 && ( geometry.hideTitleBar || geometry.borderTop <= geometry.buttonHeight );
+    }
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezepaintgovernor.h"
+
+namespace Breeze
+{
+
+    //* headroom windows needed before raising quality, initially and at most
+    static const int g_minBackoff = 3;
+    static const int g_maxBackoff = 96;
+
+    PaintGovernor *PaintGovernor::s_self = nullptr;
+
+    //__________________________________________________________________
+    PaintGovernor::~PaintGovernor()
+    { s_self = nullptr; }
+
+    //__________________________________________________________________
+    PaintGovernor *PaintGovernor::self()
+    {
+        if( !s_self )
+        { s_self = new PaintGovernor(); }
+
+        return s_self;
+    }
+
+    //__________________________________________________________________
+    void PaintGovernor::configure( bool enabled, int budget, int window )
+    {
+        m_enabled = enabled;
+        m_budget = qMax( 1, budget );
+        m_window = qMax( 1, window );
+        m_headroomWindows = 0;
+        m_backoff = g_minBackoff;
+        m_probing = false;
+        if( !m_enabled ) setLevel( QualityFull );
+        resetWindow();
+    }
+
+    //__________________________________________________________________
+    void PaintGovernor::addSample( qint64 duration )
+    {
+        if( !m_enabled ) return;
+
+        m_total += duration;
+        if( ++m_count < m_window ) return;
+
+        const qint64 average = m_total/m_count;
+        resetWindow();
+
+        // first window after raising quality tells whether the better level fits the budget
+        const bool probing = m_probing;
+        m_probing = false;
+
+        if( average > m_budget )
+        {
+
+            m_headroomWindows = 0;
+            if( probing ) m_backoff = qMin( 2*m_backoff, g_maxBackoff );
+            if( m_level < QualityCachedOnly ) setLevel( Level( m_level + 1 ) );
+            return;
+
+        }
+
+        if( probing ) m_backoff = g_minBackoff;
+
+        // cheaper levels measure below budget by design, so require sustained headroom
+        if( 2*average >= m_budget ) m_headroomWindows = 0;
+        else if( ++m_headroomWindows >= m_backoff && m_level > QualityFull )
+        {
+            m_headroomWindows = 0;
+            m_probing = true;
+            setLevel( Level( m_level - 1 ) );
+        }
+    }
+
+    //__________________________________________________________________
+    void PaintGovernor::setLevel( Level level )
+    {
+        if( m_level == level ) return;
+        m_level = level;
+        emit levelChanged();
+    }
+
+    //__________________________________________________________________
+    void PaintGovernor::resetWindow()
+    {
+        m_count = 0;
+        m_total = 0;
+    }
+
+}
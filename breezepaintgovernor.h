@@ -0,0 +1,133 @@
+#ifndef breezepaintgovernor_h
+#define breezepaintgovernor_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QObject>
+
+namespace Breeze
+{
+
+    //* lowers rendering quality step by step when painting exceeds its time budget
+    /**
+    paint durations are averaged over a window of consecutive paints. Quality is lowered
+    by one level when the average exceeds the budget. Since cheaper levels always measure
+    below budget, quality is only raised again by one level after a number of consecutive
+    windows below half the budget. That number doubles each time a raised level turns out
+    to exceed the budget again, and is reset once a raised level holds
+    */
+    class PaintGovernor: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* quality levels, from best to cheapest
+        enum Level
+        {
+            QualityFull,
+            QualityNoAnimations,
+            QualityNoGlyphAntialiasing,
+            QualityCachedOnly
+        };
+
+        //* destructor
+        ~PaintGovernor();
+
+        //* singleton
+        static PaintGovernor *self();
+
+        //* configure. Disabling the governor restores full quality
+        void configure( bool enabled, int budget, int window );
+
+        //* true if enabled
+        bool isEnabled() const
+        { return m_enabled; }
+
+        //* record one paint duration, in microseconds
+        void addSample( qint64 );
+
+        //* current level
+        Level level() const
+        { return m_level; }
+
+        //*@name quality queries
+        //@{
+
+        bool animationsAllowed() const
+        { return m_level < QualityNoAnimations; }
+
+        bool glyphAntialiasing() const
+        { return m_level < QualityNoGlyphAntialiasing; }
+
+        bool cachedOnly() const
+        { return m_level >= QualityCachedOnly; }
+
+        //@}
+
+        Q_SIGNALS:
+
+        //* emitted when quality level changes
+        void levelChanged();
+
+        private:
+
+        //* constructor
+        PaintGovernor() = default;
+
+        //* restart sampling window
+        void resetWindow();
+
+        //* change level, emitting levelChanged if needed
+        void setLevel( Level );
+
+        bool m_enabled = false;
+
+        //* average paint budget, in microseconds
+        int m_budget = 0;
+
+        //* number of paints per window
+        int m_window = 1;
+
+        //*@name current window
+        //@{
+        int m_count = 0;
+        qint64 m_total = 0;
+        //@}
+
+        Level m_level = QualityFull;
+
+        //* consecutive windows below half the budget
+        int m_headroomWindows = 0;
+
+        //* headroom windows needed before raising quality
+        int m_backoff = 0;
+
+        //* true until the first window completes after raising quality
+        bool m_probing = false;
+
+        //* singleton
+        static PaintGovernor *s_self;
+
+    };
+
+}
+
+#endif
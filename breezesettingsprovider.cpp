@@ -21,38 +21,41 @@
 #include "breezesettingsprovider.h"
 
 #include "breezeexceptionlist.h"
+#include "breezepaintgovernor.h"
 
-#include <KWindowInfo>
-
+#include <QElapsedTimer>
 #include <QTextStream>
+#include <QTimerEvent>
 
 namespace Breeze
 {
 
-    SettingsProvider *SettingsProvider::s_self = nullptr;
+    //* maximum number of cached resolutions
+    static const int s_maxResolutions = 1024;
+
+    //* delay before retrying to delete retired snapshots (ms)
+    static const int s_reclaimInterval = 100;
 
     //__________________________________________________________________
     SettingsProvider::SettingsProvider():
+        m_snapshots( nullptr ),
         m_config( KSharedConfig::openConfig( QStringLiteral("breezerc") ) )
     { reconfigure(); }
 
-    //__________________________________________________________________
-    SettingsProvider::~SettingsProvider()
-    { s_self = nullptr; }
-
     //__________________________________________________________________
     SettingsProvider *SettingsProvider::self()
     {
-        // TODO: this is not thread safe!
-        if (!s_self)
-        { s_self = new SettingsProvider(); }
-
+        // initialization of function local statics is thread safe
+        static SettingsProvider *s_self = new SettingsProvider();
         return s_self;
     }
 
     //__________________________________________________________________
     void SettingsProvider::reconfigure()
     {
+        QElapsedTimer timer;
+        timer.start();
+
         if( !m_defaultSettings )
         {
             m_defaultSettings = InternalSettingsPtr(new InternalSettings());
@@ -61,79 +64,97 @@ namespace Breeze
 
         m_defaultSettings->load();
 
-        ExceptionList exceptions;
-        exceptions.readConfig( m_config );
-        m_exceptions = exceptions.get();
+        PaintGovernor::self()->configure(
+            m_defaultSettings->paintGovernorEnabled(),
+            m_defaultSettings->paintBudget(),
+            m_defaultSettings->paintBudgetWindow() );
+
+        // build the next snapshot aside, readers keep using the current one meanwhile
+        const SettingsSnapshot* snapshot( new SettingsSnapshot(
+            DecorationConfigPtr( new DecorationConfig( *m_defaultSettings ) ),
+            ExceptionList::readRules( m_config ),
+            m_defaultSettings->dynamicTitleExceptions(),
+            m_defaultSettings->dynamicTitleExceptionsDelay() ) );
+
+        // publish. The previous snapshot is deleted once no reader can use it
+        m_snapshots.publish( snapshot );
+        reclaimSnapshots();
+
+        // resolutions depend on rules
+        m_resolutions.clear();
+        m_resolutionHits = 0;
+        m_resolutionMisses = 0;
+
+        // config is read once above, all decorations are then updated in one sweep
+        const QVector<Decoration*> decorations( m_decorations );
+        for( Decoration* decoration : decorations )
+        { decoration->updateConfig(); }
+
+        qCDebug( BREEZE ) << "SettingsProvider::reconfigure -" << decorations.size() << "decorations in" << timer.nsecsElapsed()/1000 << "us";
 
     }
 
     //__________________________________________________________________
-    InternalSettingsPtr SettingsProvider::internalSettings( Decoration *decoration ) const
+    void SettingsProvider::registerDecoration( Decoration* decoration )
+    { if( !m_decorations.contains( decoration ) ) m_decorations.append( decoration ); }
+
+    //__________________________________________________________________
+    void SettingsProvider::unregisterDecoration( Decoration* decoration )
+    { m_decorations.removeOne( decoration ); }
+
+    //__________________________________________________________________
+    ResolutionKey SettingsProvider::resolutionKey( Decoration *decoration ) const
     {
+        // window properties are fetched by the decoration when rules use them, only the caption can change
+        return SnapshotPublisher::Reader( m_snapshots )->resolutionKey(
+            decoration->windowClassName(),
+            decoration->client().data()->caption(),
+            decoration->isDialog() );
+    }
 
-        QString windowTitle;
-        QString className;
+    //__________________________________________________________________
+    DecorationConfigPtr SettingsProvider::resolve( const ResolutionKey& key ) const
+    {
 
-        // get the client
-        auto client = decoration->client().data();
+        const SnapshotPublisher::Reader snapshot( m_snapshots );
+        if( snapshot->rules.isEmpty() ) return snapshot->defaultConfig;
 
-        foreach( auto internalSettings, m_exceptions )
+        auto iter = m_resolutions.constFind( key );
+        if( iter != m_resolutions.constEnd() )
         {
+            ++m_resolutionHits;
+            return iter.value();
+        }
 
-            // discard disabled exceptions
-            if( !internalSettings->enabled() ) continue;
-
-            // discard exceptions with empty exception pattern
-            if( internalSettings->exceptionPattern().isEmpty() ) continue;
-
-            if (internalSettings->isDialog())
-            {
-                KWindowInfo info(client->windowId(), NET::WMWindowType);
-                if (info.valid()
-                    && info.windowType(NET::NormalMask | NET::DialogMask) != NET::Dialog) {
-                    continue;
-                }
-            }
-
-            /*
-            decide which value is to be compared
-            to the regular expression, based on exception type
-            */
-            QString value;
-            switch( internalSettings->exceptionType() )
-            {
-                case InternalSettings::ExceptionWindowTitle:
-                {
-                    value = windowTitle.isEmpty() ? (windowTitle = client->caption()):windowTitle;
-                    break;
-                }
-
-                default:
-                case InternalSettings::ExceptionWindowClassName:
-                {
-                    if( className.isEmpty() )
-                    {
-                        // retrieve class name
-                        KWindowInfo info( client->windowId(), nullptr, NET::WM2WindowClass );
-                        QString window_className( QString::fromUtf8(info.windowClassName()) );
-                        QString window_class( QString::fromUtf8(info.windowClassClass()) );
-                        className = window_className + QStringLiteral(" ") + window_class;
-                    }
-
-                    value = className;
-                    break;
-                }
-
-            }
-
-            // check matching
-            if( QRegExp( internalSettings->exceptionPattern() ).indexIn( value ) >= 0 )
-            { return internalSettings; }
+        ++m_resolutionMisses;
+        const DecorationConfigPtr config( snapshot->resolve( key ) );
 
-        }
+        // titles are unbounded, start over rather than growing forever
+        if( m_resolutions.size() >= s_maxResolutions ) m_resolutions.clear();
+        m_resolutions.insert( key, config );
+        return config;
 
-        return m_defaultSettings;
+    }
 
+    //__________________________________________________________________
+    void SettingsProvider::reclaimSnapshots()
+    {
+        if( m_snapshots.reclaim() > 0 ) m_reclaimTimer.start( s_reclaimInterval, this );
+        else m_reclaimTimer.stop();
+    }
+
+    //__________________________________________________________________
+    void SettingsProvider::timerEvent( QTimerEvent* event )
+    {
+        if( event->timerId() == m_reclaimTimer.timerId() ) reclaimSnapshots();
+        else QObject::timerEvent( event );
+    }
+
+    //__________________________________________________________________
+    qreal SettingsProvider::resolutionHitRate() const
+    {
+        const quint64 total = m_resolutionHits + m_resolutionMisses;
+        return total > 0 ? qreal( m_resolutionHits )/total : 0;
     }
 
 }
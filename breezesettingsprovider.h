@@ -23,10 +23,15 @@
 #include "breezedecoration.h"
 #include "breezesettings.h"
 #include "breeze.h"
+#include "breezesettingssnapshot.h"
+#include "breezesnapshotpublisher.h"
 
 #include <KSharedConfig>
 
+#include <QBasicTimer>
+#include <QHash>
 #include <QObject>
+#include <QVector>
 
 namespace Breeze
 {
@@ -39,36 +44,80 @@ namespace Breeze
         public:
 
         //* destructor
-        ~SettingsProvider();
+        ~SettingsProvider() = default;
 
-        //* singleton
+        //* singleton. First call must happen in the main thread
         static SettingsProvider *self();
 
-        //* internal settings for given decoration
-        InternalSettingsPtr internalSettings(Decoration *) const;
+        //* published snapshots. Readers are safe in any thread, lock free, and never wait for reconfigure
+        const SnapshotPublisher& snapshots() const
+        { return m_snapshots; }
+
+        //* resolution key for given decoration, from its window properties and caption
+        ResolutionKey resolutionKey( Decoration* ) const;
+
+        //* effective settings for given key, memoised. Main thread only
+        DecorationConfigPtr resolve( const ResolutionKey& ) const;
+
+        //* true if exceptions must be re-evaluated when window titles change
+        bool dynamicTitleExceptions() const
+        { return SnapshotPublisher::Reader( m_snapshots )->dynamicTitleExceptions; }
+
+        //* delay before re-evaluating title exceptions, in milliseconds
+        int dynamicTitleExceptionsDelay() const
+        { return SnapshotPublisher::Reader( m_snapshots )->dynamicTitleExceptionsDelay; }
+
+        //*@name live decorations, reconfigured together. Main thread only
+        //@{
+        void registerDecoration( Decoration* );
+        void unregisterDecoration( Decoration* );
+        //@}
+
+        //* fraction of resolve() calls answered from the resolution cache, for diagnostics
+        qreal resolutionHitRate() const;
 
         public Q_SLOTS:
 
-        //* reconfigure
+        //* reconfigure, and publish a new snapshot
         void reconfigure();
 
+        protected:
+
+        //* retry deleting retired snapshots
+        void timerEvent( QTimerEvent* ) override;
+
         private:
 
+        //* delete retired snapshots, retrying later if some might still be read
+        void reclaimSnapshots();
+
         //* contructor
         SettingsProvider();
 
-        //* default configuration
+        //* default configuration, only used to load settings in reconfigure
         InternalSettingsPtr m_defaultSettings;
 
-        //* exceptions
-        InternalSettingsList m_exceptions;
+        //* published snapshots
+        SnapshotPublisher m_snapshots;
+
+        //* retry timer, for snapshots that could not be deleted yet
+        QBasicTimer m_reclaimTimer;
+
+        //* resolved settings, for the current snapshot. Main thread only
+        mutable QHash<ResolutionKey, DecorationConfigPtr> m_resolutions;
+
+        //*@name resolution statistics
+        //@{
+        mutable quint64 m_resolutionHits = 0;
+        mutable quint64 m_resolutionMisses = 0;
+        //@}
+
+        //* live decorations
+        QVector<Decoration*> m_decorations;
 
         //* config object
         KSharedConfigPtr m_config;
 
-        //* singleton
-        static SettingsProvider *s_self;
-
     };
 
 }
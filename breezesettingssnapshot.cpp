@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesettingssnapshot.h"
+
+#include "breeze.h"
+
+namespace Breeze
+{
+
+    //* effective settings for given exception, overlaid on default settings
+    static DecorationConfigPtr overlay( const DecorationConfigPtr& defaultConfig, const ExceptionRule& exception )
+    {
+        DecorationConfig config( *defaultConfig );
+
+        // propagate all features found in mask to the output configuration
+        config.customBorderSize = exception.mask & BorderSize;
+        if( config.customBorderSize ) config.borderSize = exception.borderSize;
+        config.hideTitleBar = exception.hideTitleBar;
+        config.opaqueTitleBar = exception.opaqueTitleBar;
+        config.opacityOverride = exception.opacityOverride;
+
+        // exceptions that change nothing share the default configuration
+        if( config == *defaultConfig ) return defaultConfig;
+        else return DecorationConfigPtr( new DecorationConfig( config ) );
+    }
+
+    //__________________________________________________________________
+    SettingsSnapshot::SettingsSnapshot(
+        const DecorationConfigPtr& defaultConfig,
+        const ExceptionRuleList& exceptions,
+        bool dynamicTitleExceptions,
+        int dynamicTitleExceptionsDelay ):
+        defaultConfig( defaultConfig ),
+        dynamicTitleExceptionsDelay( dynamicTitleExceptionsDelay )
+    {
+
+        // compile rules, discarding exceptions that can never match
+        for( const ExceptionRule& exception : exceptions )
+        {
+            if( !exception.enabled ) continue;
+            if( exception.pattern.isEmpty() ) continue;
+
+            Rule rule;
+            rule.exception = exception;
+            rule.expression.setPattern( exception.pattern );
+            if( !rule.expression.isValid() ) continue;
+
+            rule.config = overlay( defaultConfig, exception );
+
+            // plain class names are matched all at once, other patterns one by one
+            const int index = rules.size();
+            if( exception.type == InternalSettings::ExceptionWindowClassName && LiteralIndex::isLiteral( exception.pattern ) )
+            {
+                literalIndex.insert( exception.pattern, index );
+            } else {
+                rule.expression.optimize();
+                sequentialRules.append( index );
+            }
+
+            rules.append( rule );
+
+            if( exception.isDialog ) hasDialogRules = true;
+            if( exception.type == InternalSettings::ExceptionWindowTitle ) hasTitleRules = true;
+            else hasClassNameRules = true;
+        }
+
+        literalIndex.build();
+
+        this->dynamicTitleExceptions = hasTitleRules && dynamicTitleExceptions;
+
+    }
+
+    //__________________________________________________________________
+    ResolutionKey SettingsSnapshot::resolutionKey( const QString& className, const QString& title, bool isDialog ) const
+    {
+        ResolutionKey key;
+        if( hasClassNameRules ) key.className = className;
+        if( hasTitleRules ) key.title = title;
+        if( hasDialogRules ) key.isDialog = isDialog;
+        return key;
+    }
+
+    //__________________________________________________________________
+    DecorationConfigPtr SettingsSnapshot::resolve( const ResolutionKey& key ) const
+    {
+
+        // true if rule matches
+        auto matches = [&key]( const Rule& rule )
+        {
+            if( rule.exception.isDialog && !key.isDialog ) return false;
+
+            /*
+            decide which value is to be compared
+            to the regular expression, based on exception type
+            */
+            switch( rule.exception.type )
+            {
+                case InternalSettings::ExceptionWindowTitle:
+                return rule.expression.match( key.title ).hasMatch();
+
+                default:
+                case InternalSettings::ExceptionWindowClassName:
+                return rule.expression.match( key.className ).hasMatch();
+            }
+        };
+
+        // literal class name rules contained in the class name, in exception order
+        const QVector<int> literalMatches( literalIndex.match( key.className ) );
+
+        // walk both lists in exception order, so that the first matching exception wins
+        auto literal = literalMatches.constBegin();
+        for( int index : sequentialRules )
+        {
+            for( ; literal != literalMatches.constEnd() && *literal < index; ++literal )
+            { if( key.isDialog || !rules[*literal].exception.isDialog ) return rules[*literal].config; }
+
+            if( matches( rules[index] ) ) return rules[index].config;
+        }
+
+        for( ; literal != literalMatches.constEnd(); ++literal )
+        { if( key.isDialog || !rules[*literal].exception.isDialog ) return rules[*literal].config; }
+
+        return defaultConfig;
+
+    }
+
+}
@@ -0,0 +1,109 @@
+#ifndef breezesettingssnapshot_h
+#define breezesettingssnapshot_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezedecorationconfig.h"
+#include "breezeexceptionlist.h"
+#include "breezeliteralindex.h"
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+namespace Breeze
+{
+
+    //* window properties exceptions depend on
+    /** properties that no enabled rule uses are left empty, so that more windows share a resolution */
+    struct ResolutionKey
+    {
+        QString className;
+        QString title;
+        bool isDialog = false;
+
+        bool operator == (const ResolutionKey& other ) const
+        { return isDialog == other.isDialog && className == other.className && title == other.title; }
+
+        friend uint qHash( const ResolutionKey& key, uint seed )
+        { return ::qHash( key.className, seed ) ^ ::qHash( key.title, seed ) * 31 ^ uint( key.isDialog ); }
+    };
+
+    //* immutable settings and rules, published as a whole on each reconfigure
+    /**
+    a snapshot is never modified once built, so that it can be read from any thread
+    while the next one is being built
+    */
+    struct SettingsSnapshot
+    {
+
+        //* enabled exception, with its pattern compiled once per reconfigure
+        struct Rule
+        {
+            ExceptionRule exception;
+            QRegularExpression expression;
+
+            //* effective settings, overlaid on default settings
+            DecorationConfigPtr config;
+        };
+
+        //* constructor. Compiles rules, discarding exceptions that can never match
+        explicit SettingsSnapshot(
+            const DecorationConfigPtr& defaultConfig,
+            const ExceptionRuleList& exceptions = ExceptionRuleList(),
+            bool dynamicTitleExceptions = false,
+            int dynamicTitleExceptionsDelay = 0 );
+
+        //* default effective settings, shared by all decorations without exception
+        DecorationConfigPtr defaultConfig;
+
+        //* rules, in exception order
+        QVector<Rule> rules;
+
+        //* indices of rules that are not in the literal index, in exception order
+        QVector<int> sequentialRules;
+
+        //* rule indices for plain class name patterns
+        LiteralIndex literalIndex;
+
+        //*@name window properties used by rules
+        //@{
+        bool hasClassNameRules = false;
+        bool hasTitleRules = false;
+        bool hasDialogRules = false;
+        //@}
+
+        //*@name dynamic title exceptions
+        //@{
+        bool dynamicTitleExceptions = false;
+        int dynamicTitleExceptionsDelay = 0;
+        //@}
+
+        //* key for given window properties, leaving out those no rule depends on
+        ResolutionKey resolutionKey( const QString& className, const QString& title, bool isDialog ) const;
+
+        //* first matching exception, or default settings
+        DecorationConfigPtr resolve( const ResolutionKey& ) const;
+
+    };
+
+}
+
+#endif
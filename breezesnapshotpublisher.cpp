@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesnapshotpublisher.h"
+
+#include <algorithm>
+
+namespace Breeze
+{
+
+    //__________________________________________________________________
+    SnapshotPublisher::SnapshotPublisher( const SettingsSnapshot* snapshot ):
+        m_current( snapshot ),
+        m_phase( 0 )
+    {
+        m_readers[0] = 0;
+        m_readers[1] = 0;
+    }
+
+    //__________________________________________________________________
+    SnapshotPublisher::~SnapshotPublisher()
+    {
+        for( const Retired& retired : m_retired )
+        { delete retired.snapshot; }
+
+        delete m_current.load();
+    }
+
+    //__________________________________________________________________
+    void SnapshotPublisher::publish( const SettingsSnapshot* snapshot )
+    {
+        // counters read by reclaim() are read after the swap
+        const SettingsSnapshot* previous = m_current.exchange( snapshot );
+        if( previous )
+        {
+            Retired retired;
+            retired.snapshot = previous;
+            retired.pending = 0x3;
+            m_retired.append( retired );
+        }
+    }
+
+    //__________________________________________________________________
+    int SnapshotPublisher::reclaim()
+    {
+        if( m_retired.isEmpty() ) return 0;
+
+        /*
+        readers load the snapshot after registering, and stay registered while using it,
+        so a counter seen at zero holds no reader of any snapshot retired before
+        */
+        for( int phase = 0; phase < 2; ++phase )
+        {
+            if( m_readers[phase].load() != 0 ) continue;
+            for( Retired& retired : m_retired )
+            { retired.pending &= ~( 1<<phase ); }
+        }
+
+        auto iter = std::remove_if( m_retired.begin(), m_retired.end(),
+            []( const Retired& retired )
+            {
+                if( retired.pending ) return false;
+                delete retired.snapshot;
+                return true;
+            } );
+        m_retired.erase( iter, m_retired.end() );
+
+        // new readers go to the other counter, so that the current one drains
+        if( !m_retired.isEmpty() ) m_phase.store( 1 - m_phase.load() );
+
+        return m_retired.size();
+    }
+
+    //__________________________________________________________________
+    SnapshotPublisher::Reader::Reader( const SnapshotPublisher& publisher ):
+        m_publisher( publisher ),
+        m_phase( publisher.m_phase.load() )
+    {
+        // the snapshot is loaded once registered
+        ++m_publisher.m_readers[m_phase];
+        m_snapshot = m_publisher.m_current.load();
+    }
+
+    //__________________________________________________________________
+    SnapshotPublisher::Reader::~Reader()
+    { --m_publisher.m_readers[m_phase]; }
+
+}
@@ -0,0 +1,118 @@
+#ifndef breezesnapshotpublisher_h
+#define breezesnapshotpublisher_h
+
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezesettingssnapshot.h"
+
+#include <QVector>
+
+#include <atomic>
+
+namespace Breeze
+{
+
+    //* publishes settings snapshots to concurrent readers, read-copy-update style
+    /**
+    readers register in one of two counters, then load the current snapshot. Registering and
+    loading are lock free and never wait for the writer. A replaced snapshot is retired, and deleted
+    once both counters have been seen at zero after it was replaced, since no reader can use it anymore.
+    The counter new readers register in alternates on each reclaim, so that both drain.
+    Publishing and reclaiming must happen in a single thread.
+
+    Atomics are sequentially consistent: a reader registers then loads the snapshot, while the writer
+    swaps the snapshot then reads the counters, and either side must see the other's first step
+    */
+    class SnapshotPublisher
+    {
+
+        public:
+
+        //* constructor. Takes ownership of the initial snapshot
+        explicit SnapshotPublisher( const SettingsSnapshot* );
+
+        //* destructor. Deletes current and retired snapshots, no reader must be left
+        ~SnapshotPublisher();
+
+        //* replace current snapshot, retiring the previous one. Takes ownership
+        void publish( const SettingsSnapshot* );
+
+        //* delete retired snapshots that no reader can use. Returns the number of snapshots still retired
+        /** snapshots that are still retired are only deleted by a later call */
+        int reclaim();
+
+        //* read access to the snapshot current at construction, valid until destruction
+        class Reader
+        {
+
+            public:
+
+            //* constructor
+            explicit Reader( const SnapshotPublisher& );
+
+            //* destructor
+            ~Reader();
+
+            const SettingsSnapshot* operator -> () const
+            { return m_snapshot; }
+
+            const SettingsSnapshot& operator * () const
+            { return *m_snapshot; }
+
+            private:
+
+            Q_DISABLE_COPY( Reader )
+
+            const SnapshotPublisher& m_publisher;
+
+            //* counter this reader is registered in
+            int m_phase = 0;
+
+            const SettingsSnapshot* m_snapshot = nullptr;
+
+        };
+
+        private:
+
+        Q_DISABLE_COPY( SnapshotPublisher )
+
+        //* current snapshot
+        std::atomic<const SettingsSnapshot*> m_current;
+
+        //* counter new readers register in
+        std::atomic<int> m_phase;
+
+        //* active readers, per counter
+        mutable std::atomic<int> m_readers[2];
+
+        //* replaced snapshot, with the counters still to be seen at zero, one bit per counter
+        struct Retired
+        {
+            const SettingsSnapshot* snapshot = nullptr;
+            int pending = 0;
+        };
+
+        //* retired snapshots. Writer thread only
+        QVector<Retired> m_retired;
+
+    };
+
+}
+
+#endif